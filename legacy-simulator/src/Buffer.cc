@@ -14,171 +14,126 @@
 // 
 
 #include "Buffer.h"
-#include "StorageDevice.h"
+#include <algorithm>
+#include <climits>
 
 namespace fattreenew {
 
-Define_Module(Buffer);
+Buffer::Buffer() : ps_timer(nullptr) {}
 
-void Buffer::initialize()
+Buffer::~Buffer() {
+    cancelAndDelete(ps_timer);
+}
+
+void Buffer::initialize(int stage)
 {
+    if(stage == 1){
+        resolveIds();
+        buildGateTable();
+        return;
+    }
+
 //    buffer_full = false;
+    rng = par("rng").intValue();
+    max_batch = par("max_batch").intValue();
+    buffer_capacity = 0;
+    read_bw = write_bw = 0;
+
+    buffer_queue.setDiscipline(RequestQueue::parseDiscipline(par("queue_discipline").stringValue()));
+    occupancy.clear();
 
-    if(strcmp(getName(), "flashBuffer") == 0){
-        avail_buffer_size = par("flash_buffer").doubleValue();
-        read_bw = par("read_storage_flash_bw").doubleValue();
-        write_bw = par("write_storage_flash_bw").doubleValue();
-    }else if(strcmp(getName(), "oss_memory")==0 || strcmp(getName(), "cn_memory")==0){
-        avail_buffer_size = par("DRAM_buffer").doubleValue();
-        read_bw = par("read_DRAM_buffer_bw").doubleValue();
-        write_bw = par("write_DRAM_buffer_bw").doubleValue();
-    }else if(strcmp(getName(), "hcaBuffer")==0 || strcmp(getName(), "hbaBuffer")==0 || strcmp(getName(), "core")==0){
-        avail_buffer_size = par("SRAM_buffer").doubleValue();
-        read_bw = par("read_SRAM_buffer_bw").doubleValue();
-        write_bw = par("write_SRAM_buffer_bw").doubleValue();
-    }else if(strcmp(getName(), "aggr")==0 || strcmp(getName(), "edge")==0){
-        avail_buffer_size = par("switch_buffer").doubleValue();
-        read_bw = par("read_switch_bw").doubleValue();
-        write_bw = par("write_switch_bw").doubleValue();
+    const char* model = par("service_model").stringValue();
+    if(strcmp(model, "parallel") == 0){
+        service_model = SERVICE_PARALLEL;
+    }else if(strcmp(model, "single") == 0){
+        service_model = SERVICE_CHANNELS;
+        num_channels = 1;
+    }else if(strcmp(model, "channels") == 0){
+        service_model = SERVICE_CHANNELS;
+        num_channels = par("service_channels").intValue();
+        if(num_channels < 1)
+            throw cRuntimeError("%s needs at least one service channel!\n", getFullPath().c_str());
+    }else if(strcmp(model, "shared") == 0){
+        service_model = SERVICE_SHARED;
+        ps_timer = new cMessage("psTimer");
     }else{
-        cRuntimeError("Need to define/rename a new buffer!\n");
+        throw cRuntimeError("Unknown service model %s!\n", model);
     }
-
-    std::string q_name = getName();
-    q_name.append("Queue");
-    buffer_queue = new cQueue(q_name.c_str());
-    buffer_queue->setup(comp);
+    in_service = 0;
+    virtual_time = 0;
+    last_update = simTime();
+    busy_since = simTime();
+    busy_time = SIMTIME_ZERO;
 
     qLenSignal = registerSignal("queueLength");
+    utilizationSignal = registerSignal("serviceUtilization");
+    bufferUtilizationSignal = registerSignal("bufferUtilization");
+}
+
+void Buffer::setMemory(const char* size_par, const char* read_par, const char* write_par)
+{
+    buffer_capacity = par(size_par).doubleValue() * MB;
+    read_bw = par(read_par).doubleValue();
+    write_bw = par(write_par).doubleValue();
 }
 
 void Buffer::handleMessage(cMessage *msg)
 {
+    if(msg == ps_timer){
+        completeShared();
+        return;
+    }
+
     Request* req = check_and_cast<Request*>(msg);
 
-    if(strcmp(getName(), "flashBuffer") == 0){ // if at OST's flash buffer
-        if(!msg->isSelfMessage()){
-            emit(qLenSignal, buffer_queue->getLength());
-            req->setArriveModule_time(simTime());
-
-            if((!req->getFinished() && !checkDiskStatus()) ||
-                    avail_buffer_size < (double)req->getByteLength()/MB){
-                buffer_queue->insert(req);
-            }else{
-                avail_buffer_size -= (double)req->getByteLength() / MB;
-                simtime_t later_time = calcSendDelay(req);
-                scheduleAt(later_time, req);
-            }
-        }else{
-            avail_buffer_size += (double)req->getByteLength() / MB;
-            if(req->getFinished()){
-                send(req, "port$o", getGateTo("port$o", "payloadOST"));
-            }else{
-                send(req, "port$o", getGateTo("port$o", "storageDevice")); // Assume one flash memory coonected with only 1 disk drive!
-            }
-            sendFromBuffer();
-        }
+    if(!msg->isSelfMessage()){
+        emit(qLenSignal, (int)buffer_queue.getLength());
+        req->setArriveModule_time(simTime());
+        onArrival(req);
+
+        if(canAdmit(req))
+            admit(req);
+        else
+            buffer_queue.push(req);
+    }else{
+        endService();
+        release(req);
     }
+}
 
-    else if(strcmp(getName(), "hcaBuffer")==0 || strcmp(getName(), "hbaBuffer")==0){
-        if(!msg->isSelfMessage()){
-            req->setArriveModule_time(simTime());
-
-            if(avail_buffer_size < (double)MTU/MB){
-                buffer_queue->insert(req);
-            }else{
-                avail_buffer_size -= (double)req->getByteLength() / MB;
-                simtime_t later_time = calcSendDelay(req);
-                scheduleAt(later_time, req);
-            }
-        }else{
-            avail_buffer_size += (double)req->getByteLength() / MB;
-            if(strcmp(getName(), "hcaBuffer") == 0)
-                send(req, "port$o", getGateTo("port$o", "hca_payload"));
-            else if(strcmp(getName(), "hbaBuffer") == 0)
-                send(req, "port$o", getGateTo("port$o", "hba_payload"));
-            sendFromBuffer();
-        }
+void Buffer::finish()
+{
+    occupancy.recordScalars(this, "buffer");
 
-    }
+    simtime_t busy = busy_time + (in_service ? simTime() - busy_since : SIMTIME_ZERO);
+    recordScalar("busyTime", busy);
+    recordScalar("utilization", simTime() > SIMTIME_ZERO ? busy.dbl() / simTime().dbl() : 0.0);
+}
 
-    else if(strcmp(getName(), "oss_memory") == 0){
-        emit(qLenSignal, buffer_queue->getLength());
-        if(!msg->isSelfMessage()){
-            req->setArriveModule_time(simTime());
-
-            if(avail_buffer_size < (double)req->getByteLength() / MB){
-                buffer_queue->insert(req);
-            }else{
-                avail_buffer_size -= (double)req->getByteLength() / MB;
-                simtime_t later_time = calcSendDelay(req);
-                if(strcmp(req->getSenderModule()->getParentModule()->getName(), "pci") == 0){
-                    req->setNext_hop_addr("oss_hub_mem_hba");
-                }else if(strcmp(req->getSenderModule()->getName(), "oss_hub_hba_ost") == 0){
-                    req->setNext_hop_addr("pci");
-                }
-                scheduleAt(later_time, req);
-            }
-        }else{
-            avail_buffer_size += (double)req->getByteLength() / MB;
-            send(req, "port$o", getGateTo("port$o", req->getNext_hop_addr()));
-            sendFromBuffer();
-        }
-    }
+bool Buffer::canAdmit(Request* req) {
+    return hasRoom(req->getByteLength());
+}
+
+bool Buffer::hasRoom(int64_t bytes) {
+    return occupancy.getBytes() + bytes <= (uint64_t)buffer_capacity;
+}
+
+void Buffer::admit(Request* req) {
+    occupancy.add(req->getByteLength());
+    emitBufferUtilization();
+    onAdmit(req);
+    startService(req);
+}
 
-    else if(strcmp(getName(), "cn_memory") == 0){
-            if(!msg->isSelfMessage()){
-                req->setArriveModule_time(simTime());
-
-                if(avail_buffer_size < (double)req->getByteLength() / MB){
-                    buffer_queue->insert(req);
-                }else{
-                    avail_buffer_size -= (double)req->getByteLength() / MB;
-                    simtime_t later_time = calcSendDelay(req);
-                    scheduleAt(later_time, req);
-                }
-            }else{
-                avail_buffer_size += (double)req->getByteLength() / MB;
-                if(req->getFinished() && strcmp(req->getSrc_addr(), getParentModule()->getFullName())==0){ // read from target (write has been sent to sink module)
-                    req->setByteLength(0);
-                }else if(!req->getFinished() && strcmp(req->getDes_addr(), getParentModule()->getFullName())==0){ // r/w on target cn
-                    req->setFinished(true);
-                    if(req->getWork_type() == 'r'){
-                        req->setByteLength(req->getFrag_size());
-                    }else{
-                        req->setByteLength(0);
-                    }
-                }
-                send(req, "port$o", getGateTo("port$o", "pci"));
-                sendFromBuffer();
-            }
-        }
-
-    else if(strcmp(getName(), "core")==0 || strcmp(getName(), "aggr")==0 || strcmp(getName(), "edge")==0){
-            if(!msg->isSelfMessage()){
-                req->setArriveModule_time(simTime());
-                std::string cur_path = req->getSendPath();
-                cur_path.empty() ? req->setNext_hop_addr(popPath(req, 'b').c_str()) : req->setNext_hop_addr(popPath(req, 's').c_str());
-
-                if(avail_buffer_size < (double)MTU/MB){
-                    buffer_queue->insert(req);
-                }else{
-                    avail_buffer_size -= (double)req->getByteLength() / MB;
-                    simtime_t later_time = calcSendDelay(req);
-                    scheduleAt(later_time, req);
-                }
-
-            }else{
-                avail_buffer_size += (double)req->getByteLength() / MB;
-                send(req, "port$o", getGateTo("port$o", req->getNext_hop_addr()));
-                sendFromBuffer();
-            }
-
-        }
-
-}
-
-simtime_t Buffer::calcSendDelay(Request* req) {
+void Buffer::release(Request* req) {
+    occupancy.remove(req->getByteLength());
+    forward(req);
+    emitBufferUtilization();
+    drainQueue();
+}
+
+double Buffer::serviceTime(Request* req) {
+    // at the full read or write bandwidth
     double proc_time;
     if(req->getWork_type() == 'r'){
         proc_time = 8.0 / read_bw;
@@ -188,43 +143,122 @@ simtime_t Buffer::calcSendDelay(Request* req) {
         proc_time = proc_time * (req->getByteLength() / (double)MB );
     }
 
-    return simTime() + proc_time;
+    return proc_time;
 }
 
-const bool Buffer::checkDiskStatus() {
-    for(int i=0; i<gateSize("port$o"); i++) {
-        cGate* g = gate("port$o", i);
-        if(strcmp(g->getNextGate()->getOwnerModule()->getName(), "storageDevice") == 0){
-            StorageDevice* dev = check_and_cast<StorageDevice*>(g->getNextGate()->getOwnerModule());
-            return dev->isFree();
-        }
+void Buffer::startService(Request* req) {
+    if(service_model == SERVICE_SHARED){
+        advanceShared();
+        ps_finish.emplace(virtual_time + serviceTime(req), req);
+        setInService(in_service + 1);
+        scheduleShared();
+    }else if(service_model == SERVICE_CHANNELS && in_service >= num_channels){
+        service_wait.push_back(req);
+    }else{
+        setInService(in_service + 1);
+        scheduleAt(simTime() + serviceTime(req), req);
     }
-    return false;
 }
 
-void Buffer::sendFromBuffer() {
-    if(buffer_queue->isEmpty()) return;
-    if(strcmp(getName(), "flashBuffer")==0 && !checkDiskStatus()) return;
+void Buffer::endService() {
+    // the channel goes to the next admitted request, if one waits
+    if(!service_wait.empty()){
+        Request* next = service_wait.front();
+        service_wait.pop_front();
+        scheduleAt(simTime() + serviceTime(next), next);
+    }else{
+        setInService(in_service - 1);
+    }
+}
 
-    Request* req_in_queue = check_and_cast<Request*>(buffer_queue->pop());
-    avail_buffer_size -= (double)req_in_queue->getByteLength() / MB;
-    simtime_t later_time = calcSendDelay(req_in_queue);
-    scheduleAt(later_time, req_in_queue);
+void Buffer::advanceShared() {
+    // processor sharing: each of the in_service requests gets 1/in_service of the bandwidth,
+    // so the work done per request (in seconds at full bandwidth) grows at that rate
+    if(in_service)
+        virtual_time += (simTime() - last_update).dbl() / in_service;
+    last_update = simTime();
 }
 
-int Buffer::getGateTo(const char* gate_type, const char* dest) {
-    std::string cur_mod_name = getFullName();
-    if(system_layout.count(cur_mod_name) && system_layout[cur_mod_name].count(dest))
-        return system_layout[cur_mod_name][dest].second;
+void Buffer::scheduleShared() {
+    cancelEvent(ps_timer);
+    if(!ps_finish.empty())
+        scheduleAt(simTime() + std::max(ps_finish.begin()->first - virtual_time, 0.0) * in_service, ps_timer);
+}
 
-    std::vector<int> gate_vec;
-    for(int i=0; i<gateSize(gate_type); i++){
-        cGate* g = gate(gate_type, i);
-        if(strcmp(g->getNextGate()->getOwnerModule()->getName(), dest) == 0){
-            gate_vec.push_back(i);
-        }
+void Buffer::completeShared() {
+    advanceShared();
+    while(!ps_finish.empty() && ps_finish.begin()->first <= virtual_time + 1e-15){
+        Request* req = ps_finish.begin()->second;
+        ps_finish.erase(ps_finish.begin());
+        setInService(in_service - 1);
+        release(req);
     }
-    return gate_vec[intuniform(0, gate_vec.size()-1, par("rng").intValue())];
+    scheduleShared();
+}
+
+void Buffer::emitBufferUtilization() {
+    if(buffer_capacity > 0)
+        emit(bufferUtilizationSignal, (double)occupancy.getBytes() / buffer_capacity);
+}
+
+void Buffer::setInService(int n) {
+    if(in_service == 0 && n > 0)
+        busy_since = simTime();
+    else if(in_service > 0 && n == 0)
+        busy_time += simTime() - busy_since;
+    in_service = n;
+
+    double utilization = service_model == SERVICE_CHANNELS ? (double)in_service / num_channels : (in_service ? 1.0 : 0.0);
+    emit(utilizationSignal, utilization);
+}
+
+void Buffer::drainQueue() {
+    // admit queued requests in one pass for as long as they fit; an empty buffer takes the head
+    // of the queue even if it does not fit, as the old one-by-one admission did, so it cannot stall
+    for(int admitted=0; max_batch <= 0 || admitted < max_batch; admitted++){
+        if(buffer_queue.isEmpty() || !canServeQueued())
+            return;
+        if(!canAdmit(buffer_queue.peek()) && occupancy.getPackets() > 0)
+            return;
+        admit(buffer_queue.pop());
+    }
+}
+
+void Buffer::resolveIds() {
+    node_id = system_topology.getId(getFullName());
+    parent_id = system_topology.intern(getParentModule()->getFullName());
+    pci_id = system_topology.intern("pci");
+    hub_hba_id = system_topology.intern("oss_hub_mem_hba");
+}
+
+void Buffer::buildGateTable() {
+    // a module of the network graph is reached through the gate system_topology stores for it,
+    // modules inside a node are found by name and every gate to them is a candidate
+    gate_table.clear();
+    for(int i=0; i<gateSize("port$o"); i++){
+        cModule* next = gate("port$o", i)->getNextGate()->getOwnerModule();
+        uint32_t next_id = system_topology.intern(next->getFullName());
+        int gate_index = system_topology.findGate(node_id, next_id);
+        if(gate_index != Topology::NO_GATE)
+            gate_table.emplace_back(next_id, gate_index);
+        else
+            gate_table.emplace_back(system_topology.intern(next->getName()), i);
+    }
+    std::sort(gate_table.begin(), gate_table.end());
+    gate_table.erase(std::unique(gate_table.begin(), gate_table.end()), gate_table.end());
+}
+
+int Buffer::getGateTo(uint32_t dest) {
+    auto first = std::lower_bound(gate_table.begin(), gate_table.end(), std::make_pair(dest, INT_MIN));
+    auto last = first;
+    while(last != gate_table.end() && last->first == dest)
+        last++;
+
+    if(first == last)
+        throw cRuntimeError("%s has no gate to %s!\n", getFullPath().c_str(), system_topology.getName(dest).c_str());
+    if(last - first == 1)
+        return first->second;
+    return (first + intuniform(0, last - first - 1, rng))->second;
 }
 
 } //namespace
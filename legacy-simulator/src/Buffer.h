@@ -18,34 +18,85 @@
 
 #include <omnetpp.h>
 #include "General.h"
+#include "RequestQueue.h"
+#include <deque>
+#include <map>
 
 using namespace omnetpp;
 
 namespace fattreenew {
 
 /**
- * TODO - Generated class
+ * Memory stage of a request: an admitted request holds buffer space for the
+ * time its bytes take at the read/write bandwidth, others wait in the queue
+ * until space is released. Subclasses pick their block of memory parameters
+ * and where a request goes next.
  */
 class Buffer : public cSimpleModule
 {
   public:
-
+    Buffer();
+    virtual ~Buffer();
   protected:
-    virtual void initialize() override;
+    virtual int numInitStages() const override { return 2; } // system_topology is built by sink[0] in stage 0
+    virtual void initialize(int stage) override;
     virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;
     simsignal_t qLenSignal;
+    simsignal_t utilizationSignal;
+    simsignal_t bufferUtilizationSignal;
+
+    uint32_t node_id;    // IDs in system_topology
+    uint32_t parent_id;
+    uint32_t pci_id;
+    uint32_t hub_hba_id;
+    void resolveIds();
+
+    void setMemory(const char*, const char*, const char*); // NED parameters of size (MB), read and write bandwidth (Mbps)
+    bool hasRoom(int64_t);
+    void drainQueue();         // admit queued requests for as long as they fit, at most max_batch
+    int getGateTo(uint32_t);   // port$o index towards a module ID
+
+    // role of the subclass
+    virtual void onArrival(Request*) {}
+    virtual bool canAdmit(Request*);           // default: buffer space for the whole request
+    virtual bool canServeQueued() { return true; }
+    virtual void onAdmit(Request*) {}
+    virtual void forward(Request*) = 0;        // the request leaves the buffer
+
   private:
-//    bool buffer_full;
-    double avail_buffer_size;
+    int64_t buffer_capacity;      // bytes
     double read_bw;
     double write_bw;
-    simtime_t calcSendDelay(Request*);
-    cQueue* buffer_queue;
+    RequestQueue buffer_queue;
+    std::vector<std::pair<uint32_t, int>> gate_table; // (neighbor ID, port$o index), sorted
+    int rng;
+    void buildGateTable();
+    OccupancyTracker occupancy;   // requests being passed on, they hold buffer space until they leave
+    void admit(Request*);
+    void release(Request*);
+    int max_batch;                // admissions per drainQueue() pass, 0 for no limit
+    void emitBufferUtilization();
 
-    // functions for flash memory connected with disks
-    const bool checkDiskStatus();
-    void sendFromBuffer();
-    int getGateTo(const char*, const char*);
+    // service of the admitted requests: all at full bandwidth, num_channels at a time, or sharing it
+    enum ServiceModel { SERVICE_PARALLEL, SERVICE_CHANNELS, SERVICE_SHARED };
+    ServiceModel service_model;
+    int num_channels;
+    int in_service;
+    std::deque<Request*> service_wait;        // admitted, waiting for a channel
+    double virtual_time;                      // SHARED: service received by each request so far, in seconds
+    simtime_t last_update;
+    std::multimap<double, Request*> ps_finish; // SHARED: virtual finish time of each request in service
+    cMessage* ps_timer;
+    simtime_t busy_since;
+    simtime_t busy_time;
+    double serviceTime(Request*);
+    void startService(Request*);
+    void endService();
+    void advanceShared();
+    void scheduleShared();
+    void completeShared();
+    void setInService(int);
 };
 
 } //namespace
@@ -0,0 +1,61 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "DramBuffer.h"
+
+namespace fattreenew {
+
+Define_Module(DramBuffer);
+
+void DramBuffer::initialize(int stage)
+{
+    Buffer::initialize(stage);
+    if(stage != 0)
+        return;
+
+    setMemory("DRAM_buffer", "read_DRAM_buffer_bw", "write_DRAM_buffer_bw");
+    in_oss = strcmp(getParentModule()->getName(), "oss") == 0;
+}
+
+void DramBuffer::onAdmit(Request* req) {
+    if(!in_oss)
+        return;
+    if(strcmp(req->getSenderModule()->getParentModule()->getName(), "pci") == 0){
+        req->setNext_hop_addr(hub_hba_id);
+    }else if(strcmp(req->getSenderModule()->getName(), "oss_hub_hba_ost") == 0){
+        req->setNext_hop_addr(pci_id);
+    }
+}
+
+void DramBuffer::forward(Request* req) {
+    if(in_oss){
+        send(req, "port$o", getGateTo(req->getNext_hop_addr()));
+        return;
+    }
+
+    if(req->getFinished() && req->getSrc_addr() == parent_id){ // read from target (write has been sent to sink module)
+        req->setByteLength(0);
+    }else if(!req->getFinished() && req->getDes_addr() == parent_id){ // r/w on target cn
+        req->setFinished(true);
+        if(req->getWork_type() == 'r'){
+            req->setByteLength((int64_t)req->getFrag_size() * req->getFrag_count());
+        }else{
+            req->setByteLength(0);
+        }
+    }
+    send(req, "port$o", getGateTo(pci_id));
+}
+
+} //namespace
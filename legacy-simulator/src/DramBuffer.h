@@ -0,0 +1,40 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef __FATTREENEW_DRAMBUFFER_H_
+#define __FATTREENEW_DRAMBUFFER_H_
+
+#include "Buffer.h"
+
+namespace fattreenew {
+
+/**
+ * Main memory of a CN or an OSS. In an OSS it passes data between the PCIe
+ * and the HBA hub; in a CN it turns a request around at its target and
+ * sends it back out through the PCIe.
+ */
+class DramBuffer : public Buffer
+{
+  protected:
+    virtual void initialize(int stage) override;
+    virtual void onAdmit(Request*) override;
+    virtual void forward(Request*) override;
+  private:
+    bool in_oss;
+};
+
+} //namespace
+
+#endif
@@ -0,0 +1,75 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "FlashBuffer.h"
+
+namespace fattreenew {
+
+Define_Module(FlashBuffer);
+
+FlashBuffer::FlashBuffer() : disk(nullptr) {}
+
+FlashBuffer::~FlashBuffer() {
+    // the disk may outlive this flash while the network is torn down
+    if(disk && disk->isSubscribed("diskFree", this))
+        disk->unsubscribe("diskFree", this);
+}
+
+void FlashBuffer::initialize(int stage)
+{
+    Buffer::initialize(stage);
+    if(stage == 1){
+        payload_ost_id = system_topology.intern("payloadOST");
+        storage_id = system_topology.intern("storageDevice");
+        return;
+    }
+
+    setMemory("flash_buffer", "read_storage_flash_bw", "write_storage_flash_bw");
+
+    disk = nullptr;
+    for(int i=0; i<gateSize("port$o"); i++) {
+        cModule* next = gate("port$o", i)->getNextGate()->getOwnerModule();
+        if(strcmp(next->getName(), "storageDevice") == 0)
+            disk = check_and_cast<StorageDevice*>(next);
+    }
+    if(!disk)
+        throw cRuntimeError("%s is not connected to a storage device!\n", getFullPath().c_str());
+    disk->subscribe("diskFree", this);
+}
+
+void FlashBuffer::receiveSignal(cComponent* source, simsignal_t signal, bool free, cObject* details) {
+    // queued writes were waiting for the disk
+    Enter_Method_Silent();
+    if(free)
+        drainQueue();
+}
+
+bool FlashBuffer::canAdmit(Request* req) {
+    return (req->getFinished() || disk->isFree()) && hasRoom(req->getByteLength());
+}
+
+bool FlashBuffer::canServeQueued() {
+    return disk->isFree();
+}
+
+void FlashBuffer::forward(Request* req) {
+    if(req->getFinished()){
+        send(req, "port$o", getGateTo(payload_ost_id));
+    }else{
+        send(req, "port$o", getGateTo(storage_id)); // Assume one flash memory coonected with only 1 disk drive!
+    }
+}
+
+} //namespace
@@ -0,0 +1,48 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef __FATTREENEW_FLASHBUFFER_H_
+#define __FATTREENEW_FLASHBUFFER_H_
+
+#include "Buffer.h"
+#include "StorageDevice.h"
+
+namespace fattreenew {
+
+/**
+ * Flash in front of an OST disk. New data waits while the disk queue is
+ * full and is drained when the disk signals diskFree; data read back goes
+ * to the OST payload.
+ */
+class FlashBuffer : public Buffer, public cListener
+{
+  public:
+    FlashBuffer();
+    virtual ~FlashBuffer();
+    virtual void receiveSignal(cComponent*, simsignal_t, bool, cObject*) override;
+  protected:
+    virtual void initialize(int stage) override;
+    virtual bool canAdmit(Request*) override;
+    virtual bool canServeQueued() override;
+    virtual void forward(Request*) override;
+  private:
+    uint32_t payload_ost_id;
+    uint32_t storage_id;
+    StorageDevice* disk;   // the one disk behind this flash
+};
+
+} //namespace
+
+#endif
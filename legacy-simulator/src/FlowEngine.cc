@@ -0,0 +1,327 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "FlowEngine.h"
+#include <algorithm>
+#include <limits>
+
+namespace fattreenew {
+
+Define_Module(FlowEngine);
+
+FlowEngine::FlowEngine() : timer(nullptr) {}
+
+FlowEngine::~FlowEngine() {
+    cancelAndDelete(timer);
+    for(auto& item:parts_left)
+        delete item.first;
+}
+
+void FlowEngine::initialize()
+{
+    timer = new cMessage("flowTimer");
+    last_update = simTime();
+    num_completed = 0;
+    num_recomputes = 0;
+    hybrid = !std::string(par("packet_region").stringValue()).empty();
+    min_packet_share = par("min_packet_share").doubleValue();
+
+    activeFlowsSignal = registerSignal("activeFlows");
+}
+
+void FlowEngine::startFlow(Request* req) {
+    Enter_Method("startFlow");
+    take(req);
+    advance();
+
+    // reads move data from the destination back to the source
+    bool write = req->getWork_type() == 'w';
+    uint32_t data_src = write ? req->getSrc_addr() : req->getDes_addr();
+    uint32_t data_des = write ? req->getDes_addr() : req->getSrc_addr();
+    const RouteService::Route& route = system_routes.getPinnedRoute(write ? req->getSend_route() : req->getBack_route());
+
+    Flow flow;
+    flow.req = req;
+    flow.rate = 0;
+    uint32_t prev = data_src;
+    for(uint32_t k=0; k<route.length; k++){
+        uint32_t hop = route.hop(k);
+        NodeKind kind = system_topology.getKind(hop);
+        if(kind == NODE_INIF_EDGE_CN || kind == NODE_INIF_AGGR_EDGE || kind == NODE_INIF_CORE_AGGR){
+            cModule* bundle = getNodeModule(hop);
+            flow.resources.push_back(getResource(bundle, bundleSlot(bundle, getNodeModule(prev))));
+        }
+        prev = hop;
+    }
+    flow.resources.push_back(getResource(getNodeModule(data_src)->getSubmodule("pci"), SLOT_FORWARD));
+    flow.resources.push_back(getResource(getNodeModule(data_des)->getSubmodule("pci"), SLOT_BACKWARD));
+
+    if(system_topology.getKind(req->getDes_addr()) == NODE_OSS){ // one flow per stripe OST, as sendOstByStripe spreads them
+        cModule* oss = getNodeModule(req->getDes_addr());
+        int num_ost = oss->getSubmoduleVectorSize("ost");
+        int num_stripes = std::min(STRIPE_COUNT, num_ost);
+        parts_left[req] = num_stripes;
+        for(int i=0; i<num_stripes; i++){
+            int ost_ind = (req->getTarget_ost() + i) % num_ost;
+            Flow part = flow;
+            part.remaining = (double)req->getData_size() / num_stripes;
+            part.resources.push_back(getResource(oss->getSubmodule("sas", ost_ind), write ? SLOT_BACKWARD : SLOT_FORWARD));
+            part.resources.push_back(getResource(oss->getSubmodule("ost", ost_ind), write ? SLOT_WRITE : SLOT_READ));
+            flows.push_back(part);
+        }
+    }else{
+        parts_left[req] = 1;
+        flow.remaining = req->getData_size();
+        flows.push_back(flow);
+    }
+
+    recomputeRates();
+    scheduleNext();
+}
+
+bool FlowEngine::isPacketLevel(Request* req) {
+    if(!hybrid)
+        return false;
+    resolveRegion();
+
+    // end points, and the edge switches they hang from
+    const RouteService::Route& route = system_routes.getPinnedRoute(req->getSend_route());
+    uint32_t first_edge = Topology::NO_NODE;
+    uint32_t last_edge = Topology::NO_NODE;
+    for(uint32_t k=0; k<route.length; k++){
+        if(system_topology.getKind(route.hop(k)) == NODE_EDGE){
+            if(first_edge == Topology::NO_NODE)
+                first_edge = route.hop(k);
+            last_edge = route.hop(k);
+        }
+    }
+    for(uint32_t node:{req->getSrc_addr(), req->getDes_addr(), first_edge, last_edge}){
+        if(node < in_region.size() && in_region[node])
+            return true;
+    }
+    return false;
+}
+
+void FlowEngine::resolveRegion() {
+    if(!in_region.empty())
+        return;
+
+    in_region.resize(system_topology.getNumNodes(), false);
+    for(auto& name:cStringTokenizer(par("packet_region").stringValue()).asVector()){
+        uint32_t id = system_topology.getId(name);
+        if(id == Topology::NO_NODE)
+            throw cRuntimeError("Unknown module %s in packet_region!\n", name.c_str());
+        in_region[id] = true;
+    }
+}
+
+void FlowEngine::handleMessage(cMessage *msg)
+{
+    if(msg != timer)
+        throw cRuntimeError("Unexpected message %s at flow engine!\n", msg->getName());
+
+    advance();
+    for(size_t i=0; i<flows.size();){
+        if(flows[i].remaining >= 1.0){ // sub-byte leftovers are rounding of the completion time
+            i++;
+            continue;
+        }
+        Request* req = flows[i].req;
+        flows[i] = std::move(flows.back());
+        flows.pop_back();
+        if(--parts_left[req] == 0){
+            parts_left.erase(req);
+            deliver(req);
+        }
+    }
+
+    recomputeRates();
+    scheduleNext();
+}
+
+void FlowEngine::finish(){
+    recordScalar("flowsCompleted", num_completed);
+    recordScalar("rateRecomputations", num_recomputes);
+
+    // leave the channels as configured for whatever runs next
+    for(auto& link:shared_links){
+        for(size_t i=0; i<link.channels.size(); i++)
+            link.channels[i]->setDatarate(link.datarates[i]);
+    }
+}
+
+cModule* FlowEngine::getNodeModule(uint32_t node) {
+    if(node_modules.empty()){
+        node_modules.resize(system_topology.getNumNodes(), nullptr);
+        for(cModule::SubmoduleIterator it(getSystemModule()); !it.end(); it++){
+            uint32_t id = system_topology.getId((*it)->getFullName());
+            if(id < node_modules.size())
+                node_modules[id] = *it;
+        }
+    }
+
+    if(node >= node_modules.size() || !node_modules[node])
+        throw cRuntimeError("No network module for node %u!\n", node);
+    return node_modules[node];
+}
+
+uint32_t FlowEngine::getResource(cModule* module, Slot slot) {
+    int64_t key = (int64_t)module->getId() * 4 + slot;
+    auto it = resource_ids.find(key);
+    if(it != resource_ids.end())
+        return it->second;
+
+    Resource res;
+    res.capacity = 0;
+    res.cap_left = 0;
+    res.load = 0;
+    res.num_flows = 0;
+    if(slot == SLOT_READ || slot == SLOT_WRITE){
+        res.capacity = storageCapacity(module, slot == SLOT_WRITE);
+    }else{
+        SharedLink link;
+        link.resource = resources.size();
+        bundleChannels(module, slot == SLOT_FORWARD, link.channels);
+        for(auto channel:link.channels){
+            link.datarates.push_back(channel->getDatarate());
+            res.capacity += channel->getDatarate() / 8;
+        }
+        if(hybrid && module->getParentModule() == getSystemModule()) // Infiniband, not a PCIe/SAS inside a node
+            shared_links.push_back(link);
+    }
+    if(res.capacity <= 0)
+        throw cRuntimeError("%s has no bandwidth for the flow-level model!\n", module->getFullPath().c_str());
+
+    resource_ids[key] = resources.size();
+    resources.push_back(res);
+    return resources.size()-1;
+}
+
+FlowEngine::Slot FlowEngine::bundleSlot(cModule* bundle, cModule* from) {
+    // port[0] is the in_flow side of a bundle
+    return bundle->gate("port$o", 0)->getNextGate()->getOwnerModule() == from ? SLOT_FORWARD : SLOT_BACKWARD;
+}
+
+void FlowEngine::bundleChannels(cModule* bundle, bool forward, std::vector<cDatarateChannel*>& channels) {
+    // Infiniband/PCIe/SAS: the datarate channels between link_input[] and link_output[]
+    const char* side = forward ? "link_input" : "link_output";
+    for(int i=0; i<bundle->getSubmoduleVectorSize(side); i++){
+        cModule* link = bundle->getSubmodule(side, i);
+        for(int j=0; j<link->gateSize("port$o"); j++){
+            cGate* g = link->gate("port$o", j);
+            if(checkPortWithTransCable(g))
+                channels.push_back(check_and_cast<cDatarateChannel*>(g->getTransmissionChannel()));
+        }
+    }
+}
+
+double FlowEngine::storageCapacity(cModule* ost, bool write) {
+    double capacity = 0;
+    for(int i=0; i<ost->getSubmoduleVectorSize("storageDevice"); i++){
+        cModule* dev = ost->getSubmodule("storageDevice", i);
+        capacity += dev->par(write ? "write_bw" : "read_bw").doubleValue() * MB / 8; // same units as StorageDevice::updateMsgProcTime()
+    }
+    return capacity;
+}
+
+void FlowEngine::advance() {
+    double elapsed = (simTime() - last_update).dbl();
+    if(elapsed > 0){
+        for(auto& flow:flows)
+            flow.remaining -= flow.rate * elapsed;
+    }
+    last_update = simTime();
+}
+
+void FlowEngine::recomputeRates() {
+    // Progressive filling: the resource with the smallest fair share fixes the rate of all its
+    // unfixed flows, which then leave every other resource they cross. Repeat until all are fixed.
+    num_recomputes++;
+    for(auto& res:resources)
+        res.load = 0;
+    std::vector<uint32_t> used;
+    for(auto& flow:flows){
+        for(uint32_t r:flow.resources){
+            if(resources[r].num_flows++ == 0){
+                resources[r].cap_left = resources[r].capacity;
+                used.push_back(r);
+            }
+        }
+    }
+
+    std::vector<bool> fixed(flows.size(), false);
+    size_t num_fixed = 0;
+    while(num_fixed < flows.size()){
+        uint32_t bottleneck = UINT32_MAX;
+        double share = std::numeric_limits<double>::infinity();
+        for(uint32_t r:used){
+            if(resources[r].num_flows && resources[r].cap_left / resources[r].num_flows < share){
+                share = resources[r].cap_left / resources[r].num_flows;
+                bottleneck = r;
+            }
+        }
+        if(bottleneck == UINT32_MAX)
+            throw cRuntimeError("Flow without any resource at %s!\n", getFullName());
+        share = std::max(share, 0.0);
+
+        for(size_t i=0; i<flows.size(); i++){
+            if(fixed[i] || std::find(flows[i].resources.begin(), flows[i].resources.end(), bottleneck) == flows[i].resources.end())
+                continue;
+            fixed[i] = true;
+            num_fixed++;
+            flows[i].rate = share;
+            for(uint32_t r:flows[i].resources){
+                resources[r].cap_left -= share;
+                resources[r].load += share;
+                resources[r].num_flows--;
+            }
+        }
+    }
+}
+
+void FlowEngine::scheduleNext() {
+    cancelEvent(timer);
+    double next = std::numeric_limits<double>::infinity();
+    for(auto& flow:flows){
+        if(flow.rate > 0)
+            next = std::min(next, std::max(flow.remaining, 0.0) / flow.rate);
+    }
+    if(next < std::numeric_limits<double>::infinity())
+        scheduleAt(simTime() + next, timer);
+
+    emit(activeFlowsSignal, (unsigned long)flows.size());
+    updateSharedLinks();
+}
+
+void FlowEngine::deliver(Request* req) {
+    // the same hand-over as in packet mode: reads are counted by sink[0], writes by sink[1]
+    num_completed++;
+    req->setFinished(true);
+    req->setFrag_size(req->getData_size());
+    req->setFrag_count(1);
+    sendDirect(req, getSystemModule()->getSubmodule("sink", req->getWork_type() == 'w' ? 1 : 0), "directIn");
+}
+
+void FlowEngine::updateSharedLinks() {
+    // packets get what the fluid flows leave of a link, but never less than min_packet_share
+    for(auto& link:shared_links){
+        const Resource& res = resources[link.resource];
+        double share = std::max(1.0 - res.load / res.capacity, min_packet_share);
+        for(size_t i=0; i<link.channels.size(); i++)
+            link.channels[i]->setDatarate(link.datarates[i] * share);
+    }
+}
+
+} //namespace
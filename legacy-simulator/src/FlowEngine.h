@@ -0,0 +1,106 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef __FATTREENEW_FLOWENGINE_H_
+#define __FATTREENEW_FLOWENGINE_H_
+
+#include <omnetpp.h>
+#include "General.h"
+
+using namespace omnetpp;
+
+namespace fattreenew {
+
+/**
+ * Flow-level (fluid) alternative to packet forwarding. Each request from a
+ * WorkGenerator becomes a flow along its interned route; a request to an OSS
+ * is split into one flow per stripe OST. Flows share the Infiniband bundles,
+ * the PCIe of both end points and the SAS/OST devices max-min fairly, with
+ * rates recomputed only when a flow starts or completes. A request whose
+ * flows are all through is handed to the Sink like a packet-mode request.
+ *
+ * Modules listed in packet_region (e.g. "edge[3] oss[1]") stay packet level:
+ * requests from or to them, or to the CNs under a listed edge switch, are
+ * forwarded as packets, and the fluid load on every Infiniband bundle is
+ * taken off the datarate of its channels.
+ */
+class FlowEngine : public cSimpleModule
+{
+  public:
+    FlowEngine();
+    virtual ~FlowEngine();
+    void startFlow(Request*); // takes over the request
+    bool isPacketLevel(Request*);
+  protected:
+    virtual void initialize() override;
+    virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;
+    simsignal_t activeFlowsSignal;
+  private:
+    // bundles are full duplex: FORWARD enters an Infiniband bundle at port[0] and leaves a PCIe towards the network;
+    // storage is shared by reads and writes separately
+    enum Slot { SLOT_FORWARD, SLOT_BACKWARD, SLOT_READ, SLOT_WRITE };
+
+    struct Resource {
+        double capacity;     // bytes/s
+        double cap_left;     // scratch for recomputeRates()
+        double load;         // sum of the flow rates
+        uint32_t num_flows;
+    };
+
+    // Infiniband channels shared with packet-level traffic
+    struct SharedLink {
+        uint32_t resource;
+        std::vector<cDatarateChannel*> channels;
+        std::vector<double> datarates; // nominal, bit/s
+    };
+
+    struct Flow {
+        Request* req;
+        double remaining;    // bytes
+        double rate;         // bytes/s
+        std::vector<uint32_t> resources;
+    };
+
+    std::vector<Resource> resources;
+    std::unordered_map<int64_t, uint32_t> resource_ids; // module ID * 4 + slot
+    std::vector<cModule*> node_modules;                // top-level modules by node ID
+    std::vector<Flow> flows;
+    std::unordered_map<Request*, int> parts_left;      // flows of a request still running
+    std::vector<bool> in_region;                       // by node ID, empty while not resolved
+    bool hybrid;
+    double min_packet_share;
+    std::vector<SharedLink> shared_links;
+    cMessage* timer;
+    simtime_t last_update;
+    uint64_t num_completed;
+    uint64_t num_recomputes;
+
+    cModule* getNodeModule(uint32_t);
+    uint32_t getResource(cModule*, Slot);
+    void resolveRegion();
+    static Slot bundleSlot(cModule*, cModule*);
+    static void bundleChannels(cModule*, bool, std::vector<cDatarateChannel*>&);
+    static double storageCapacity(cModule*, bool);
+    void advance();
+    void recomputeRates();
+    void scheduleNext();
+    void updateSharedLinks();
+    void deliver(Request*);
+};
+
+} //namespace
+
+#endif
@@ -1,12 +1,5 @@
 #include "General.h"
 
-int comp(cObject* r1, cObject* r2){
-    Request* t1 = check_and_cast<Request*>(r1);
-    Request* t2 = check_and_cast<Request*>(r2);
-    int ans = t1->getArriveModule_time() > t2->getArriveModule_time()?1:0; // FIFO order
-    return ans;
-}
-
 bool checkPortWithTransCable(cGate* g) {
     auto channel = g->getChannel();
     return channel && channel->isTransmissionChannel();
@@ -20,6 +13,20 @@ simtime_t transTimestampByCable(cGate* g) {
     return trans_time;
 }
 
+PathPolicy parsePathPolicy(const char* name) {
+    if(strcmp(name, "random") == 0) return POLICY_RANDOM;
+    if(strcmp(name, "flow_hash") == 0) return POLICY_FLOW_HASH;
+    if(strcmp(name, "least_queued") == 0) return POLICY_LEAST_QUEUED;
+    if(strcmp(name, "power_of_two") == 0) return POLICY_POWER_OF_TWO;
+    throw cRuntimeError("Unknown path policy %s!\n", name);
+}
+
+uint32_t flowHash(Request* req, uint32_t salt) {
+    uint32_t key[4] = {req->getSrc_addr(), req->getDes_addr(), req->getMaster_id(), salt};
+    uint64_t hash = fnv1a(key, sizeof(key));
+    return (uint32_t)(hash ^ (hash >> 32));
+}
+
 bool compareStrVec(const std::vector<std::string>& a, const std::vector<std::string>& b) {
     if(a.size() < b.size())
         return true;
@@ -28,24 +35,35 @@ bool compareStrVec(const std::vector<std::string>& a, const std::vector<std::str
     return false;
 }
 
-std::string popPath(Request* req, char direction) {
-    if(direction != 's' && direction != 'b')
-        cRuntimeError("Unknown sent/back direction of a message!\n");
-
-    std::string cur_path, new_path;
-    size_t pos_comma;
+void pinRoutes(const Request* req) {
+    system_routes.pinRoute(req->getSend_route());
+    system_routes.pinRoute(req->getBack_route());
+    system_routes.pinRoute(req->getLoad_route());
+}
 
-    if(direction == 's'){
-        cur_path = req->getSendPath();
-    }else if(direction == 'b'){
-        cur_path = req->getBackPath();
-    }
-    pos_comma = cur_path.find(',', 0);
+void unpinRoutes(const Request* req) {
+    system_routes.unpinRoute(req->getSend_route());
+    system_routes.unpinRoute(req->getBack_route());
+    system_routes.unpinRoute(req->getLoad_route());
+}
 
-    if(pos_comma != std::string::npos)
-        new_path = cur_path.substr(pos_comma+1, std::string::npos);
+bool hasPath(Request* req, char direction) {
+    uint32_t route_id = direction=='s' ? req->getSend_route() : req->getBack_route();
+    unsigned hop = direction=='s' ? req->getSend_hop() : req->getBack_hop();
+    return route_id != RouteService::NO_ROUTE && hop < system_routes.getPinnedRoute(route_id).length;
+}
 
-    direction=='s' ? req->setSendPath(new_path.c_str()) : req->setBackPath(new_path.c_str());
+uint32_t popPath(Request* req, char direction) {
+    if(direction != 's' && direction != 'b')
+        throw cRuntimeError("Unknown sent/back direction of a message!\n");
+    uint32_t route_id = direction=='s' ? req->getSend_route() : req->getBack_route();
+    unsigned hop = direction=='s' ? req->getSend_hop() : req->getBack_hop();
+    if(route_id == RouteService::NO_ROUTE)
+        return Topology::NO_NODE;
 
-    return cur_path.substr(0, pos_comma);
+    const RouteService::Route& route = system_routes.getPinnedRoute(route_id); // one lookup per hop, read by index
+    if(hop >= route.length)
+        return Topology::NO_NODE;
+    direction=='s' ? req->setSend_hop(hop+1) : req->setBack_hop(hop+1);
+    return route.hop(hop);
 }
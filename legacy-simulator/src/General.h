@@ -8,7 +8,10 @@
 #include <unordered_map>
 #include <unordered_set>
 #include "request_m.h"
-#include <regex>
+#include "Topology.h"
+#include "RouteService.h"
+#include "RequestPool.h"
+#include "OccupancyTracker.h"
 
 #define KB 1024
 #define MB (1024*KB)
@@ -22,19 +25,63 @@
 using namespace omnetpp;
 using namespace fattreenew;
 
-int comp(cObject*, cObject*); // comparator function for cQueue
-
 bool checkPortWithTransCable(cGate*);
 
 bool compareStrVec(const std::vector<std::string>&, const std::vector<std::string>&);
 
-std::string popPath(Request*, char);
+// the routes of a request are pinned from the WorkGenerator (or RequestPool::dup()) to RequestPool::release()
+void pinRoutes(const Request*);
+void unpinRoutes(const Request*);
+bool hasPath(Request*, char);
+uint32_t popPath(Request*, char); // node ID of the next hop, NO_NODE at the end of the route
 
 simtime_t transTimestampByCable(cGate*);
 
-extern std::unordered_map<std::string, std::unordered_map<std::string, std::pair<std::string, int>>> system_layout; // record each pair of modules with their gate name and index: <module1_name, <module2_name,<gate_name, gate_index>>>
+// equal-cost choice among ports of a Switch or routes of a WorkGenerator
+enum PathPolicy { POLICY_RANDOM, POLICY_FLOW_HASH, POLICY_LEAST_QUEUED, POLICY_POWER_OF_TWO };
+PathPolicy parsePathPolicy(const char*);
+// the same for all fragments of a request; each decision point passes its own salt (e.g. its node ID),
+// otherwise the choices of successive stages are correlated (hash % 4 fixes hash % 2)
+uint32_t flowHash(Request*, uint32_t salt);
+
+// load(i) is the occupancy of candidate i, only read by the load-aware policies
+template<typename LoadFn>
+uint32_t choosePath(cComponent* owner, PathPolicy policy, uint32_t num_paths, uint32_t hash, int rng, LoadFn load) {
+    if(num_paths <= 1)
+        return 0;
+
+    switch(policy){
+        case POLICY_FLOW_HASH:
+            return hash % num_paths;
+        case POLICY_LEAST_QUEUED: { // scan from a random start so that ties are spread
+            uint32_t start = owner->intuniform(0, num_paths-1, rng);
+            uint32_t best = start;
+            uint64_t best_load = load(start);
+            for(uint32_t k=1; k<num_paths && best_load; k++){
+                uint32_t i = (start + k) % num_paths;
+                uint64_t l = load(i);
+                if(l < best_load){
+                    best = i;
+                    best_load = l;
+                }
+            }
+            return best;
+        }
+        case POLICY_POWER_OF_TWO: {
+            uint32_t a = owner->intuniform(0, num_paths-1, rng);
+            uint32_t b = owner->intuniform(0, num_paths-2, rng);
+            if(b >= a)
+                b++;
+            return load(b) < load(a) ? b : a;
+        }
+        default:
+            return owner->intuniform(0, num_paths-1, rng);
+    }
+}
+
+extern Topology system_topology; // interned module names and, for each pair of connected modules, the gate kind and index
 extern std::vector<std::string> all_oss, all_cn;  // all OSSes and CNs
-extern std::vector<std::vector<std::string>> path_cn_cn, path_cn_oss; // paths form CN1 to CN2; CN to OSSes
-extern std::unordered_map<std::string, std::unordered_map<std::string, std::vector<std::vector<std::string>>>> all_paths;
+extern RouteService system_routes; // shortest paths from CN to CN, CN to OSS and OSS to CN
+extern RequestPool request_pool; // recycled Request objects, set up and cleared by sink[0]
 
 #endif /* GENERAL_H_ */
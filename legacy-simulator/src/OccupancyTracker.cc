@@ -0,0 +1,46 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "OccupancyTracker.h"
+
+namespace fattreenew {
+
+void OccupancyTracker::clear() {
+    packets = data_packets = max_packets = 0;
+    bytes = max_bytes = 0;
+}
+
+void OccupancyTracker::add(int64_t request_bytes) {
+    packets++;
+    data_packets += request_bytes ? 1 : 0;
+    bytes += request_bytes;
+    max_packets = std::max(max_packets, packets);
+    max_bytes = std::max(max_bytes, bytes);
+}
+
+void OccupancyTracker::remove(int64_t request_bytes) {
+    if(packets == 0 || (uint64_t)request_bytes > bytes)
+        throw cRuntimeError("Occupancy underflow: %lld bytes leave a queue holding %llu!\n", (long long)request_bytes, (unsigned long long)bytes);
+    packets--;
+    data_packets -= request_bytes ? 1 : 0;
+    bytes -= request_bytes;
+}
+
+void OccupancyTracker::recordScalars(cComponent* owner, const char* prefix) const {
+    owner->recordScalar((std::string(prefix) + "MaxPackets").c_str(), max_packets);
+    owner->recordScalar((std::string(prefix) + "MaxBytes").c_str(), max_bytes);
+}
+
+} //namespace
@@ -0,0 +1,57 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef __FATTREENEW_OCCUPANCYTRACKER_H_
+#define __FATTREENEW_OCCUPANCYTRACKER_H_
+
+#include <omnetpp.h>
+
+using namespace omnetpp;
+
+namespace fattreenew {
+
+/**
+ * Running request and byte counts of a queue, with their high-water marks.
+ * The owning module calls add() and remove() as requests enter and leave,
+ * so reading the occupancy never walks the queue.
+ */
+class OccupancyTracker
+{
+  public:
+    OccupancyTracker() { clear(); }
+
+    void clear();
+    void add(int64_t);    // bytes of the request
+    void remove(int64_t);
+
+    uint32_t getPackets() const { return packets; }
+    uint32_t getDataPackets() const { return data_packets; } // requests carrying bytes
+    uint64_t getBytes() const { return bytes; }
+    uint32_t getMaxPackets() const { return max_packets; }
+    uint64_t getMaxBytes() const { return max_bytes; }
+
+    void recordScalars(cComponent*, const char*) const; // high-water marks, under the given prefix
+
+  private:
+    uint32_t packets;
+    uint32_t data_packets;
+    uint64_t bytes;
+    uint32_t max_packets;
+    uint64_t max_bytes;
+};
+
+} //namespace
+
+#endif
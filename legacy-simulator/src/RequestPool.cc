@@ -0,0 +1,75 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "RequestPool.h"
+#include "General.h"
+
+namespace fattreenew {
+
+RequestPool::RequestPool() : free_list(nullptr), max_free(0), hits(0), misses(0) {}
+
+void RequestPool::configure(size_t max_free_requests) {
+    clear();
+    max_free = max_free_requests;
+    if(max_free){
+        free_list = new cQueue("requestPool");
+        free_list->removeFromOwnershipTree(); // outlives the module that happens to create it
+    }
+}
+
+void RequestPool::clear() {
+    delete free_list; // deletes the pooled requests it owns
+    free_list = nullptr;
+    hits = misses = 0;
+}
+
+Request* RequestPool::acquire() {
+    if(!free_list || free_list->isEmpty()){
+        misses++;
+        return new Request();
+    }
+
+    hits++;
+    Request* req = check_and_cast<Request*>(free_list->pop());
+    *req = Request(); // no routes to pin yet
+    req->setName(nullptr);
+    return req;
+}
+
+Request* RequestPool::dup(const Request* src) {
+    Request* req;
+    if(!free_list || free_list->isEmpty()){
+        misses++;
+        req = src->dup();
+    }else{
+        hits++;
+        req = check_and_cast<Request*>(free_list->pop());
+        *req = *src;
+        req->setName(src->getName());
+    }
+    pinRoutes(req);
+    return req;
+}
+
+void RequestPool::release(Request* req) {
+    unpinRoutes(req);
+    if(!free_list || (size_t)free_list->getLength() >= max_free){
+        delete req;
+        return;
+    }
+    free_list->insert(req);
+}
+
+} //namespace
@@ -0,0 +1,60 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef __FATTREENEW_REQUESTPOOL_H_
+#define __FATTREENEW_REQUESTPOOL_H_
+
+#include <omnetpp.h>
+#include "request_m.h"
+
+using namespace omnetpp;
+
+namespace fattreenew {
+
+/**
+ * Freelist of Request objects shared by the whole simulation. Modules that
+ * create, duplicate or discard requests on the hot path go through
+ * acquire()/dup()/release() instead of new/dup()/delete; released requests
+ * are kept in a cQueue, which takes ownership of them, and are handed out
+ * again by copy-assignment.
+ * A duplicate pins the routes it carries in system_routes, and a release
+ * unpins them.
+ */
+class RequestPool
+{
+  public:
+    RequestPool();
+
+    void configure(size_t); // max requests kept for reuse, 0 disables pooling
+    void clear();
+
+    Request* acquire(); // with every field at its default, like new Request()
+    Request* dup(const Request*);
+    void release(Request*);
+
+    uint64_t getHits() const { return hits; }
+    uint64_t getMisses() const { return misses; }
+    size_t getNumFree() const { return free_list ? free_list->getLength() : 0; }
+
+  private:
+    cQueue* free_list;
+    size_t max_free;
+    uint64_t hits;
+    uint64_t misses;
+};
+
+} //namespace
+
+#endif
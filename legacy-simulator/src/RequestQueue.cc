@@ -0,0 +1,73 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include <algorithm>
+#include <functional>
+#include "RequestQueue.h"
+
+namespace fattreenew {
+
+RequestQueue::RequestQueue() : discipline(FIFO), next_seq(0), length(0) {}
+
+RequestQueue::Discipline RequestQueue::parseDiscipline(const char* name) {
+    if(strcmp(name, "fifo") == 0) return FIFO;
+    if(strcmp(name, "priority") == 0) return PRIORITY;
+    if(strcmp(name, "sjf") == 0) return SJF;
+    throw cRuntimeError("Unknown queue discipline %s!\n", name);
+}
+
+void RequestQueue::push(Request* req) {
+    switch(discipline){
+        case PRIORITY:
+            fifos[req->getWork_type() == 'r' ? 0 : 1].push_back(req);
+            break;
+        case SJF:
+            heap.push_back(SjfEntry{(uint64_t)req->getFrag_size() * req->getFrag_count(), next_seq++, req});
+            std::push_heap(heap.begin(), heap.end(), std::greater<SjfEntry>());
+            break;
+        default:
+            fifos[0].push_back(req);
+    }
+    length++;
+}
+
+Request* RequestQueue::pop() {
+    if(length == 0)
+        throw cRuntimeError("Pop from an empty request queue!\n");
+
+    Request* req;
+    if(discipline == SJF){
+        std::pop_heap(heap.begin(), heap.end(), std::greater<SjfEntry>());
+        req = heap.back().req;
+        heap.pop_back();
+    }else{
+        std::deque<Request*>& fifo = fifos[0].empty() ? fifos[1] : fifos[0];
+        req = fifo.front();
+        fifo.pop_front();
+    }
+    length--;
+    return req;
+}
+
+Request* RequestQueue::peek() const {
+    if(length == 0)
+        throw cRuntimeError("Peek into an empty request queue!\n");
+
+    if(discipline == SJF)
+        return heap.front().req;
+    return fifos[0].empty() ? fifos[1].front() : fifos[0].front();
+}
+
+} //namespace
@@ -0,0 +1,64 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef __FATTREENEW_REQUESTQUEUE_H_
+#define __FATTREENEW_REQUESTQUEUE_H_
+
+#include <deque>
+#include <vector>
+#include "request_m.h"
+
+namespace fattreenew {
+
+/**
+ * Queue of waiting requests with a selectable discipline:
+ *  - FIFO: one deque, O(1) push and pop;
+ *  - PRIORITY: reads ahead of writes, FIFO within each, O(1);
+ *  - SJF: smallest frag_size*frag_count first, FIFO among equals, O(log n).
+ * The queue only holds pointers; the requests stay owned by the module.
+ */
+class RequestQueue
+{
+  public:
+    enum Discipline { FIFO, PRIORITY, SJF };
+    static Discipline parseDiscipline(const char*);
+
+    RequestQueue();
+    void setDiscipline(Discipline d) { discipline = d; }
+
+    void push(Request*);
+    Request* pop();
+    Request* peek() const;   // the request pop() would return
+    bool isEmpty() const { return length == 0; }
+    size_t getLength() const { return length; }
+
+  private:
+    struct SjfEntry {
+        uint64_t bytes;
+        uint64_t seq;
+        Request* req;
+        bool operator>(const SjfEntry& o) const { return bytes > o.bytes || (bytes == o.bytes && seq > o.seq); }
+    };
+
+    Discipline discipline;
+    std::deque<Request*> fifos[2];   // FIFO uses [0]; PRIORITY: [0] reads, [1] everything else
+    std::vector<SjfEntry> heap;      // min-heap for SJF
+    uint64_t next_seq;
+    size_t length;
+};
+
+} //namespace
+
+#endif
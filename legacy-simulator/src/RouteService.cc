@@ -0,0 +1,326 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "RouteService.h"
+#include "General.h"
+
+namespace fattreenew {
+
+RouteService::RouteService() : mode(PRECOMPUTE), max_pairs(0), hits(0), misses(0), evictions(0), refills(0) {}
+
+void RouteService::configure(Mode m, size_t max_memo_pairs) {
+    mode = m;
+    max_pairs = max_memo_pairs;
+    if(max_pairs && max_pairs < 2) // keep the previously returned pair alive too
+        max_pairs = 2;
+}
+
+void RouteService::clear() {
+    table.clear();
+    memo.clear();
+    lru.clear();
+    route_ids.clear();
+    route_keys.clear();
+    routes.clear();
+    pinned_hops.clear();
+    pins.clear();
+    reroutes.clear();
+    node_load.clear();
+    hits = misses = evictions = refills = 0;
+}
+
+void RouteService::buildAll(const std::vector<uint32_t>& endpoints, unsigned num_threads) {
+    try{
+        table.build(system_topology, endpoints, num_threads);
+    }catch(std::exception& e){
+        throw cRuntimeError("Cannot build route table: %s\n", e.what());
+    }
+}
+
+uint32_t RouteService::countPaths(uint32_t src, uint32_t des) {
+    if(mode == PRECOMPUTE)
+        return table.countPaths(src, des);
+    return lookup(src, des, true).num_paths;
+}
+
+bool RouteService::getRoute(uint32_t src, uint32_t des, uint32_t index, Route& route) {
+    return fetchRoute(src, des, index, route, true);
+}
+
+bool RouteService::fetchRoute(uint32_t src, uint32_t des, uint32_t index, Route& route, bool count) {
+    if(mode == PRECOMPUTE)
+        return table.getRoute(src, des, index, route);
+
+    route.clear();
+    MemoEntry& entry = lookup(src, des, count);
+    if(index >= entry.num_paths)
+        return false;
+    route.append(entry.hops.data() + (size_t)index*entry.path_len, entry.path_len, src > des);
+    return true;
+}
+
+uint32_t RouteService::internRoute(uint32_t src, uint32_t des, uint32_t index) {
+    auto& ids = route_ids[((uint64_t)src << 32) | des];
+    if(index < ids.size() && ids[index] != NO_ROUTE)
+        return ids[index];
+
+    Route route;
+    if(!fetchRoute(src, des, index, route, false)) // the pair was just counted by countPaths()
+        return NO_ROUTE;
+
+    if(index >= ids.size())
+        ids.resize(index+1, NO_ROUTE);
+    ids[index] = route_keys.size();
+    route_keys.push_back({src, des, index});
+    if(mode == PRECOMPUTE){ // the table is never evicted, keep the resolved route
+        routes.push_back(route);
+    }else{
+        routes.emplace_back();
+        pinned_hops.emplace_back();
+        pins.push_back(0);
+    }
+    return ids[index];
+}
+
+RouteService::Route RouteService::getInternedRoute(uint32_t route_id) {
+    if(mode == PRECOMPUTE || pins[route_id])
+        return routes[route_id];
+
+    Route route;
+    const RouteKey& key = route_keys[route_id];
+    fetchRoute(key.src, key.des, key.index, route, false);
+    return route;
+}
+
+void RouteService::pinRoute(uint32_t route_id) {
+    if(mode == PRECOMPUTE || route_id == NO_ROUTE || pins[route_id]++)
+        return;
+
+    // copy the hops in travel order, the memo may evict the pair before the last request is done
+    Route route;
+    const RouteKey& key = route_keys[route_id];
+    fetchRoute(key.src, key.des, key.index, route, false);
+    auto& hops = pinned_hops[route_id];
+    hops.resize(route.length);
+    for(uint32_t k=0; k<route.length; k++)
+        hops[k] = route.hop(k);
+    routes[route_id].clear();
+    routes[route_id].append(hops.data(), hops.size(), false); // moving the vector keeps its storage
+}
+
+void RouteService::unpinRoute(uint32_t route_id) {
+    if(mode == PRECOMPUTE || route_id == NO_ROUTE)
+        return;
+    if(!pins[route_id])
+        throw cRuntimeError("Route %u is unpinned more often than pinned!\n", route_id);
+    if(--pins[route_id])
+        return;
+
+    routes[route_id].clear();
+    std::vector<uint32_t>().swap(pinned_hops[route_id]);
+}
+
+uint32_t RouteService::rerouteVia(uint32_t route_id, unsigned hop, uint32_t next) {
+    // a shortest path passes a node once, so (route, next) also fixes the hop
+    uint64_t key = ((uint64_t)route_id << 32) | next;
+    auto it = reroutes.find(key);
+    if(it != reroutes.end())
+        return it->second;
+
+    RouteKey pair = route_keys[route_id];
+    Route current = getInternedRoute(route_id);
+    uint32_t result = NO_ROUTE;
+    if(hop < current.length && current.hop(hop) == next){
+        result = route_id;
+    }else{
+        uint32_t num_paths = mode == PRECOMPUTE ? table.countPaths(pair.src, pair.des) : lookup(pair.src, pair.des, false).num_paths;
+        for(uint32_t i=0; i<num_paths && result == NO_ROUTE; i++){
+            Route candidate;
+            if(!fetchRoute(pair.src, pair.des, i, candidate, false) || hop >= candidate.length || candidate.hop(hop) != next)
+                continue;
+            unsigned same = 0;
+            while(same < hop && candidate.hop(same) == current.hop(same))
+                same++;
+            if(same == hop)
+                result = internRoute(pair.src, pair.des, i);
+        }
+    }
+    reroutes[key] = result;
+    return result;
+}
+
+void RouteService::addLoad(uint32_t route_id, int64_t bytes) {
+    if(route_id == NO_ROUTE)
+        return;
+    if(node_load.size() < system_topology.getNumNodes())
+        node_load.resize(system_topology.getNumNodes(), 0);
+
+    Route route = getInternedRoute(route_id);
+    for(uint32_t k=0; k<route.length; k++){
+        node_load[route.hop(k)] += bytes;
+        if(node_load[route.hop(k)] < 0)
+            throw cRuntimeError("More load released than added at %s!\n", system_topology.getName(route.hop(k)).c_str());
+    }
+}
+
+uint64_t RouteService::getRouteLoad(uint32_t src, uint32_t des, uint32_t index) {
+    Route route;
+    if(!fetchRoute(src, des, index, route, false)) // a probe while choosing, not a lookup of the request
+        return 0;
+
+    uint64_t load = 0; // addLoad() keeps every counter non-negative
+    for(uint32_t k=0; k<route.length; k++){
+        uint32_t hop = route.hop(k);
+        if(hop < node_load.size())
+            load = std::max(load, (uint64_t)node_load[hop]);
+    }
+    return load;
+}
+
+RouteService::MemoEntry& RouteService::lookup(uint32_t src, uint32_t des, bool count) {
+    uint64_t key = pairKey(src, des);
+    auto it = memo.find(key);
+    if(it != memo.end()){
+        if(count)
+            hits++;
+        lru.splice(lru.begin(), lru, it->second.lru_pos);
+        return it->second;
+    }
+
+    if(count)
+        misses++;
+    else
+        refills++;
+    uint32_t from = std::min(src, des), to = std::max(src, des);
+    std::unordered_map<uint32_t, std::vector<std::vector<uint32_t>>> found;
+    findShortPaths(from, {to}, found);
+
+    MemoEntry& entry = memo[key];
+    auto& paths = found[to];
+    entry.num_paths = paths.size();
+    entry.path_len = paths.empty() ? 0 : paths[0].size();
+    for(auto& p:paths)
+        entry.hops.insert(entry.hops.end(), p.begin(), p.end());
+    lru.push_front(key);
+    entry.lru_pos = lru.begin();
+
+    while(max_pairs && memo.size() > max_pairs){
+        memo.erase(lru.back());
+        lru.pop_back();
+        evictions++;
+    }
+    return entry;
+}
+
+void RouteService::findShortPaths(uint32_t src, const std::vector<uint32_t>& targets, std::unordered_map<uint32_t, std::vector<std::vector<uint32_t>>>& found) const {
+    // Layered BFS from src: level d holds every module that may sit at position d+1 of a path,
+    // together with its predecessors on level d-1. Each target keeps the first level at which
+    // it forms a valid path, and all equal-length paths are then read back from the predecessors.
+    const size_t max_path_size = 15;
+    std::unordered_set<uint32_t> target_set(targets.begin(), targets.end());
+    std::unordered_map<uint32_t, size_t> target_level;
+    std::vector<std::unordered_map<uint32_t, std::vector<uint32_t>>> preds(max_path_size);
+    std::vector<std::vector<uint32_t>> levels(max_path_size);
+
+    levels[0].push_back(src);
+    for(size_t d=1; d<max_path_size && !levels[d-1].empty(); d++){
+        for(uint32_t mid:levels[d-1]){
+            for(auto it=system_topology.neighborsBegin(mid); it!=system_topology.neighborsEnd(mid); it++){
+                uint32_t next = *it;
+                if(target_set.count(next)){
+                    if(!checkPath(d+1))
+                        continue;
+                    auto level_it = target_level.find(next);
+                    if(level_it != target_level.end() && level_it->second != d)
+                        continue;
+                    target_level[next] = d;
+                }else if(!checkLayer(system_topology.getKind(next), d+1)){
+                    continue;
+                }
+
+                auto& next_preds = preds[d][next];
+                if(next_preds.empty() && !target_set.count(next))
+                    levels[d].push_back(next);
+                next_preds.push_back(mid);
+            }
+        }
+    }
+
+    for(uint32_t tar:targets){
+        auto level_it = target_level.find(tar);
+        if(level_it == target_level.end())
+            continue;
+
+        // walk predecessors back to src, emitting one path (without end points) per combination
+        std::vector<uint32_t> path(level_it->second-1);
+        std::vector<std::pair<size_t, uint32_t>> stack;
+        for(uint32_t prev:preds[level_it->second][tar])
+            stack.push_back({level_it->second-1, prev});
+        while(!stack.empty()){
+            auto cur = stack.back();
+            stack.pop_back();
+            if(cur.first == 0){
+                found[tar].push_back(path);
+                continue;
+            }
+            path[cur.first-1] = cur.second;
+            for(uint32_t prev:preds[cur.first][cur.second])
+                stack.push_back({cur.first-1, prev});
+        }
+    }
+}
+
+bool RouteService::checkLayer(NodeKind kind, size_t path_size) {
+    // positions (1-based) at which each fat-tree layer may appear in a CN-to-CN/OSS path
+    switch(kind){
+        case NODE_INIF_EDGE_CN:
+            return path_size==2 || path_size==6 || path_size==10 || path_size==14;
+        case NODE_EDGE_CONNECT:
+            return path_size==3 || path_size==5 || path_size==9 || path_size==13;
+        case NODE_EDGE:
+            return path_size==4 || path_size==8 || path_size==12;
+        case NODE_INIF_AGGR_EDGE:
+            return path_size==5 || path_size==7 || path_size==11;
+        case NODE_AGGR:
+            return path_size==6 || path_size==10;
+        case NODE_INIF_CORE_AGGR:
+            return path_size==7 || path_size==9;
+        case NODE_CORE:
+            return path_size==8;
+        case NODE_CN: case NODE_OSS: case NODE_SINK: // only allowed as path end points
+            return false;
+        default:
+            throw cRuntimeError("Unknown module kind in path search!\n");
+    }
+}
+
+bool RouteService::checkPath(size_t path_size) {
+    if(path_size<7 || path_size>15 || path_size%2==0) return false;
+    return true;
+   /* std::map<std::string, int> switch_count;
+    for(auto a:path){
+        auto sw_name = a.substr(0,5);
+        if(sw_name=="edge[" || sw_name=="aggr[" || sw_name=="core["){
+            switch_count[sw_name]++;
+            if(switch_count[sw_name] > 2){
+                return false;
+            }
+        }
+    }
+
+    return switch_count.size();*/
+}
+
+} //namespace
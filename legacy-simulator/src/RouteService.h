@@ -0,0 +1,119 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef __FATTREENEW_ROUTESERVICE_H_
+#define __FATTREENEW_ROUTESERVICE_H_
+
+#include <list>
+#include "RouteTable.h"
+#include "Topology.h"
+
+namespace fattreenew {
+
+/**
+ * Answers "which equal-cost paths lead from src to des" over system_topology.
+ * In PRECOMPUTE mode the symmetry-compressed RouteTable of all CN/OSS end
+ * points is built up front (or mapped from the on-disk cache). In LAZY mode a
+ * pair is searched the first time it is asked for and memoized, optionally
+ * bounded by an LRU over pairs. Either way a pair's paths are stored once and
+ * walked backwards for the opposite direction.
+ *
+ * Routes in flight are interned: a Request only carries a route ID and a hop
+ * cursor per direction, and next hops are read from the shared route. In
+ * LAZY mode an interned route is only its (pair, path index) until a request
+ * pins it; a pinned route keeps a copy of its hops until its last request
+ * unpins it, so the memo may evict the pair meanwhile and the LRU bound only
+ * bounds the hops of pairs without requests in flight.
+ */
+class RouteService
+{
+  public:
+    enum Mode { PRECOMPUTE, LAZY };
+    typedef RouteTable::Route Route;
+
+    RouteService();
+
+    void configure(Mode, size_t); // max memoized pairs for LAZY mode, 0 = unbounded
+    void clear();
+    Mode getMode() const { return mode; }
+
+    void buildAll(const std::vector<uint32_t>&, unsigned); // worker threads, 0 = one per core
+    RouteTable& getTable() { return table; }
+
+    // a Route stays valid at least until a third pair is looked up
+    uint32_t countPaths(uint32_t, uint32_t);  // the one counted memo lookup of a request
+    bool getRoute(uint32_t, uint32_t, uint32_t, Route&);
+
+    static const uint32_t NO_ROUTE = UINT32_MAX;
+    uint32_t internRoute(uint32_t, uint32_t, uint32_t);
+    Route getInternedRoute(uint32_t); // valid like a Route from getRoute(), or while the route is pinned
+    // one per request carrying the route, see RequestPool; NO_ROUTE is ignored
+    void pinRoute(uint32_t);
+    void unpinRoute(uint32_t);
+    const Route& getPinnedRoute(uint32_t route_id) const { return routes[route_id]; } // no memo lookup
+    // route of the same pair that agrees on the hops before hop and continues through next,
+    // NO_ROUTE if there is none
+    uint32_t rerouteVia(uint32_t route_id, unsigned hop, uint32_t next);
+    size_t getNumInterned() const { return route_keys.size(); }
+
+    // bytes in flight through each node, for load-aware route choice
+    void addLoad(uint32_t route_id, int64_t);            // negative to release, throws if a node would drop below 0
+    uint64_t getRouteLoad(uint32_t, uint32_t, uint32_t); // of the most loaded hop
+
+    // LAZY mode memo statistics, one lookup per countPaths() call
+    uint64_t getHits() const { return hits; }
+    uint64_t getMisses() const { return misses; }
+    uint64_t getEvictions() const { return evictions; }
+    uint64_t getRefills() const { return refills; }  // evicted pairs searched again for a route in flight
+    size_t getNumMemoized() const { return memo.size(); }
+
+  private:
+    struct MemoEntry {
+        std::vector<uint32_t> hops; // paths from the lower to the higher node ID
+        uint32_t num_paths;
+        uint32_t path_len;
+        std::list<uint64_t>::iterator lru_pos;
+    };
+
+    Mode mode;
+    size_t max_pairs;
+    RouteTable table;
+    std::unordered_map<uint64_t, MemoEntry> memo;
+    std::list<uint64_t> lru; // most recently used first
+    std::unordered_map<uint64_t, std::vector<uint32_t>> route_ids; // per directed pair, by path index
+    struct RouteKey { uint32_t src, des, index; };
+    std::vector<RouteKey> route_keys;                             // by route ID
+    std::vector<Route> routes;                                    // by route ID: resolved into the table, or into pinned_hops in LAZY mode
+    std::vector<std::vector<uint32_t>> pinned_hops;               // LAZY mode, by route ID, empty while unpinned
+    std::vector<uint32_t> pins;                                   // LAZY mode, by route ID
+    std::unordered_map<uint64_t, uint32_t> reroutes;              // (route ID, next hop) -> route ID
+    std::vector<int64_t> node_load;                               // by node ID
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t refills;
+
+    static uint64_t pairKey(uint32_t src, uint32_t des) { return src < des ? ((uint64_t)src << 32) | des : ((uint64_t)des << 32) | src; }
+    MemoEntry& lookup(uint32_t, uint32_t, bool); // counted in hits/misses or not
+    bool fetchRoute(uint32_t, uint32_t, uint32_t, Route&, bool);
+
+    void findShortPaths(uint32_t, const std::vector<uint32_t>&, std::unordered_map<uint32_t, std::vector<std::vector<uint32_t>>>&) const;
+    static bool checkLayer(NodeKind, size_t);
+    static bool checkPath(size_t);
+};
+
+} //namespace
+
+#endif
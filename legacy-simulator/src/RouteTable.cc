@@ -0,0 +1,329 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "RouteTable.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fattreenew {
+
+static const char ROUTE_FILE_MAGIC[8] = {'F','T','R','O','U','T','E','\0'};
+
+void RouteTable::Route::append(const uint32_t* seg_hops, uint32_t len, bool reversed) {
+    if(!len)
+        return;
+    segs[num_segs++] = Segment{seg_hops, len, reversed};
+    length += len;
+}
+
+uint32_t RouteTable::Route::hop(uint32_t k) const {
+    for(uint32_t i=0; i<num_segs; i++){
+        if(k < segs[i].len)
+            return segs[i].reversed ? segs[i].hops[segs[i].len-1-k] : segs[i].hops[k];
+        k -= segs[i].len;
+    }
+    return Topology::NO_NODE;
+}
+
+RouteTable::RouteTable() : access(nullptr), groups(nullptr), segments(nullptr), hops(nullptr),
+        num_access(0), num_groups(0), num_segments(0), num_hops(0), map_addr(nullptr), map_size(0) {}
+
+RouteTable::~RouteTable() {
+    unmap();
+}
+
+int RouteTable::switchRank(NodeKind kind) {
+    // order of the layers when climbing from an edge_connect group towards the core
+    switch(kind){
+        case NODE_EDGE: return 1;
+        case NODE_INIF_AGGR_EDGE: return 2;
+        case NODE_AGGR: return 3;
+        case NODE_INIF_CORE_AGGR: return 4;
+        case NODE_CORE: return 5;
+        default: return 0;
+    }
+}
+
+void RouteTable::build(const Topology& topo, const std::vector<uint32_t>& endpoints, unsigned num_threads) {
+    clear();
+    own_access.assign(topo.getNumNodes(), AccessEntry{0, 0, 0});
+
+    // access hops: follow the single link out of each end point until an edge_connect is reached
+    std::unordered_map<uint32_t, uint32_t> group_index;
+    std::vector<uint32_t> group_nodes;
+    for(uint32_t ep:endpoints){
+        uint32_t prev = Topology::NO_NODE, cur = ep;
+        AccessEntry& entry = own_access[ep];
+        entry.first_hop = own_hops.size();
+        while(topo.getKind(cur) != NODE_EDGE_CONNECT){
+            uint32_t next = Topology::NO_NODE;
+            for(auto it=topo.neighborsBegin(cur); it!=topo.neighborsEnd(cur); it++){
+                if(*it == prev)
+                    continue;
+                if(next != Topology::NO_NODE)
+                    throw std::runtime_error("End point " + topo.getName(ep) + " is not attached to a single edge_connect!");
+                next = *it;
+            }
+            if(next == Topology::NO_NODE || entry.len >= 4)
+                throw std::runtime_error("End point " + topo.getName(ep) + " is not attached to a single edge_connect!");
+            own_hops.push_back(next);
+            entry.len++;
+            prev = cur;
+            cur = next;
+        }
+
+        auto inserted = group_index.insert({cur, group_nodes.size()});
+        if(inserted.second)
+            group_nodes.push_back(cur);
+        entry.group = inserted.first->second;
+    }
+
+    // up segments of every group, searched in parallel into per-group buffers and merged in group order,
+    // so the table is identical whatever the number of threads
+    std::vector<GroupResult> results(group_nodes.size());
+    std::atomic<size_t> next_group(0);
+    auto worker = [&](){
+        std::vector<uint32_t> path;
+        for(size_t g=next_group++; g<group_nodes.size(); g=next_group++){
+            GroupResult& result = results[g];
+            for(auto it=topo.neighborsBegin(group_nodes[g]); it!=topo.neighborsEnd(group_nodes[g]); it++){
+                if(switchRank(topo.getKind(*it)) == 1){
+                    path.push_back(*it);
+                    collectSegments(topo, *it, path, result);
+                    path.pop_back();
+                }
+            }
+            std::stable_sort(result.segments.begin(), result.segments.end(), [](const SegmentEntry& a, const SegmentEntry& b){
+                return a.level < b.level || (a.level == b.level && a.top < b.top);
+            });
+        }
+    };
+
+    if(num_threads == 0)
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    num_threads = std::min<size_t>(num_threads, group_nodes.size());
+    std::vector<std::thread> threads;
+    for(unsigned i=1; i<num_threads; i++)
+        threads.emplace_back(worker);
+    worker();
+    for(auto& t:threads)
+        t.join();
+
+    for(auto& result:results){
+        own_groups.push_back(GroupEntry{own_segments.size(), (uint32_t)result.segments.size(), 0});
+        for(auto seg:result.segments){
+            seg.first_hop += own_hops.size();
+            own_segments.push_back(seg);
+        }
+        own_hops.insert(own_hops.end(), result.hops.begin(), result.hops.end());
+    }
+
+    setView();
+}
+
+void RouteTable::collectSegments(const Topology& topo, uint32_t cur, std::vector<uint32_t>& path, GroupResult& result) {
+    int rank = switchRank(topo.getKind(cur));
+    if(rank % 2){ // a switch: any path climbing up to here may turn back down
+        result.segments.push_back(SegmentEntry{cur, (uint32_t)(rank-1)/2, result.hops.size(), (uint32_t)path.size(), 0});
+        result.hops.insert(result.hops.end(), path.begin(), path.end());
+    }
+
+    for(auto it=topo.neighborsBegin(cur); it!=topo.neighborsEnd(cur); it++){
+        if(switchRank(topo.getKind(*it)) == rank+1){
+            path.push_back(*it);
+            collectSegments(topo, *it, path, result);
+            path.pop_back();
+        }
+    }
+}
+
+void RouteTable::setView() {
+    access = own_access.data();
+    groups = own_groups.data();
+    segments = own_segments.data();
+    hops = own_hops.data();
+    num_access = own_access.size();
+    num_groups = own_groups.size();
+    num_segments = own_segments.size();
+    num_hops = own_hops.size();
+}
+
+void RouteTable::clear() {
+    unmap();
+    own_access.clear();
+    own_groups.clear();
+    own_segments.clear();
+    own_hops.clear();
+    setView();
+}
+
+template<typename F>
+void RouteTable::forEachMatch(uint32_t src, uint32_t des, F f) const {
+    // walk both groups' segments level by level and stop at the lowest level with a common top
+    const GroupEntry& a = groups[access[src].group];
+    const GroupEntry& b = groups[access[des].group];
+    uint64_t i = a.first_seg, a_end = a.first_seg + a.num_segs;
+    uint64_t j = b.first_seg, b_end = b.first_seg + b.num_segs;
+
+    while(i < a_end && j < b_end){
+        uint32_t level = std::min(segments[i].level, segments[j].level);
+        bool matched = false;
+        while(i < a_end && j < b_end && segments[i].level == level && segments[j].level == level){
+            if(segments[i].top < segments[j].top){
+                i++;
+            }else if(segments[j].top < segments[i].top){
+                j++;
+            }else{
+                uint32_t top = segments[i].top;
+                Match m{i, 0, j, 0};
+                for(; i < a_end && segments[i].level == level && segments[i].top == top; i++) m.src_count++;
+                for(; j < b_end && segments[j].level == level && segments[j].top == top; j++) m.des_count++;
+                matched = true;
+                if(!f(m))
+                    return;
+            }
+        }
+        if(matched)
+            return;
+        while(i < a_end && segments[i].level == level) i++;
+        while(j < b_end && segments[j].level == level) j++;
+    }
+}
+
+uint32_t RouteTable::countPaths(uint32_t src, uint32_t des) const {
+    if(!isEndpoint(src) || !isEndpoint(des) || src == des)
+        return 0;
+
+    uint32_t count = 0;
+    forEachMatch(src, des, [&count](const Match& m){
+        count += m.src_count * m.des_count;
+        return true;
+    });
+    return count;
+}
+
+bool RouteTable::getRoute(uint32_t src, uint32_t des, uint32_t index, Route& route) const {
+    route.clear();
+    if(!isEndpoint(src) || !isEndpoint(des) || src == des)
+        return false;
+
+    bool found = false;
+    forEachMatch(src, des, [&](const Match& m){
+        uint32_t count = m.src_count * m.des_count;
+        if(index >= count){
+            index -= count;
+            return true;
+        }
+
+        const SegmentEntry& up = segments[m.src_seg + index / m.des_count];
+        const SegmentEntry& down = segments[m.des_seg + index % m.des_count];
+        route.append(hops + access[src].first_hop, access[src].len, false);
+        route.append(hops + up.first_hop, up.len, false);
+        route.append(hops + down.first_hop, down.len-1, true); // the top switch is already in 'up'
+        route.append(hops + access[des].first_hop, access[des].len, true);
+        found = true;
+        return false;
+    });
+    return found;
+}
+
+bool RouteTable::save(const std::string& file, uint64_t key, uint64_t fingerprint) const {
+    // write to a private temporary file and rename it, so concurrent runs never map a partial table
+    std::string tmp_file = file + ".tmp" + std::to_string(getpid());
+    FILE* f = fopen(tmp_file.c_str(), "wb");
+    if(!f)
+        return false;
+
+    FileHeader header;
+    memcpy(header.magic, ROUTE_FILE_MAGIC, sizeof(header.magic));
+    header.version = FILE_VERSION;
+    header.header_size = sizeof(FileHeader);
+    header.key = key;
+    header.fingerprint = fingerprint;
+    header.num_access = num_access;
+    header.num_groups = num_groups;
+    header.num_segments = num_segments;
+    header.num_hops = num_hops;
+
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+            (!num_access || fwrite(access, sizeof(AccessEntry), num_access, f) == num_access) &&
+            (!num_groups || fwrite(groups, sizeof(GroupEntry), num_groups, f) == num_groups) &&
+            (!num_segments || fwrite(segments, sizeof(SegmentEntry), num_segments, f) == num_segments) &&
+            (!num_hops || fwrite(hops, sizeof(uint32_t), num_hops, f) == num_hops);
+    ok = (fclose(f) == 0) && ok;
+
+    if(!ok || rename(tmp_file.c_str(), file.c_str()) != 0){
+        remove(tmp_file.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool RouteTable::load(const std::string& file, uint64_t key, uint64_t fingerprint) {
+    int fd = open(file.c_str(), O_RDONLY);
+    if(fd < 0)
+        return false;
+
+    struct stat st;
+    void* addr = MAP_FAILED;
+    if(fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(FileHeader))
+        addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(addr == MAP_FAILED)
+        return false;
+
+    const FileHeader* header = static_cast<const FileHeader*>(addr);
+    size_t expected_size = sizeof(FileHeader) + header->num_access*sizeof(AccessEntry) + header->num_groups*sizeof(GroupEntry) +
+            header->num_segments*sizeof(SegmentEntry) + header->num_hops*sizeof(uint32_t);
+    if(memcmp(header->magic, ROUTE_FILE_MAGIC, sizeof(header->magic)) != 0 ||
+            header->version != FILE_VERSION || header->header_size != sizeof(FileHeader) ||
+            header->key != key || header->fingerprint != fingerprint ||
+            expected_size != (size_t)st.st_size){
+        munmap(addr, st.st_size);
+        return false;
+    }
+
+    clear();
+    map_addr = addr;
+    map_size = st.st_size;
+    num_access = header->num_access;
+    num_groups = header->num_groups;
+    num_segments = header->num_segments;
+    num_hops = header->num_hops;
+    access = reinterpret_cast<const AccessEntry*>(static_cast<const char*>(addr) + sizeof(FileHeader));
+    groups = reinterpret_cast<const GroupEntry*>(access + num_access);
+    segments = reinterpret_cast<const SegmentEntry*>(groups + num_groups);
+    hops = reinterpret_cast<const uint32_t*>(segments + num_segments);
+    return true;
+}
+
+void RouteTable::unmap() {
+    if(map_addr){
+        munmap(map_addr, map_size);
+        map_addr = nullptr;
+        map_size = 0;
+    }
+}
+
+} //namespace
@@ -0,0 +1,155 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef __FATTREENEW_ROUTETABLE_H_
+#define __FATTREENEW_ROUTETABLE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Topology.h"
+
+namespace fattreenew {
+
+/**
+ * Symmetry-compressed table of the equal-cost paths between end points
+ * (CN/OSS). Every shortest path in the fat-tree is
+ *
+ *   access(src) + up(src group -> top) + reversed up(des group -> top) + reversed access(des)
+ *
+ * where access() are the hops from an end point to its edge_connect group and
+ * up() climbs from the group's edge switch to a turning switch (edge, aggr or
+ * core) at the lowest level both groups share. Only the access hops of each
+ * end point and the up segments of each group are stored; a pair's paths are
+ * instantiated from them on lookup, and each segment is walked in either
+ * direction. All arrays are flat, so the table can be saved to and
+ * memory-mapped from a versioned binary file.
+ */
+class RouteTable
+{
+  public:
+    struct Segment {
+        const uint32_t* hops;
+        uint32_t len;
+        bool reversed;
+    };
+
+    // one concrete path between two end points, interior hops only
+    struct Route {
+        Segment segs[4];
+        uint32_t num_segs;
+        uint32_t length;
+
+        Route() : num_segs(0), length(0) {}
+        void clear() { num_segs = 0; length = 0; }
+        void append(const uint32_t*, uint32_t, bool);
+        uint32_t hop(uint32_t) const;
+    };
+
+    RouteTable();
+    ~RouteTable();
+
+    void build(const Topology&, const std::vector<uint32_t>&, unsigned = 1); // worker threads, 0 = one per core
+    void clear();
+
+    bool isEndpoint(uint32_t id) const { return id < num_access && access[id].len; }
+    uint32_t countPaths(uint32_t, uint32_t) const;
+    bool getRoute(uint32_t, uint32_t, uint32_t, Route&) const;
+
+    uint64_t getNumGroups() const { return num_groups; }
+    uint64_t getNumSegments() const { return num_segments; }
+    uint64_t getNumHops() const { return num_hops; }
+    bool isMapped() const { return map_addr != nullptr; }
+    static int switchRank(NodeKind); // 1 (edge) .. 5 (core), 0 below the edge layer
+
+    // on-disk cache, keyed by the topology parameters and checked against the topology fingerprint
+    bool save(const std::string&, uint64_t, uint64_t) const;
+    bool load(const std::string&, uint64_t, uint64_t);
+
+  private:
+    static const uint32_t FILE_VERSION = 2;
+
+    struct AccessEntry {     // indexed by node ID; len == 0 for modules that are not end points
+        uint32_t group;
+        uint32_t len;
+        uint64_t first_hop;  // hops from the end point out to its group, group included
+    };
+
+    struct GroupEntry {
+        uint64_t first_seg;  // segments sorted by (level, top)
+        uint32_t num_segs;
+        uint32_t reserved;
+    };
+
+    struct SegmentEntry {
+        uint32_t top;        // turning switch, last hop of the segment
+        uint32_t level;      // 0 edge, 1 aggr, 2 core
+        uint64_t first_hop;
+        uint32_t len;
+        uint32_t reserved;
+    };
+
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t header_size;
+        uint64_t key;
+        uint64_t fingerprint;
+        uint64_t num_access;
+        uint64_t num_groups;
+        uint64_t num_segments;
+        uint64_t num_hops;
+    };
+
+    struct Match {           // segments of both groups that meet at the same top switch
+        uint64_t src_seg;
+        uint32_t src_count;
+        uint64_t des_seg;
+        uint32_t des_count;
+    };
+
+    // owned storage while building
+    std::vector<AccessEntry> own_access;
+    std::vector<GroupEntry> own_groups;
+    std::vector<SegmentEntry> own_segments;
+    std::vector<uint32_t> own_hops;
+
+    // active view, either into the vectors above or into a read-only mapping
+    const AccessEntry* access;
+    const GroupEntry* groups;
+    const SegmentEntry* segments;
+    const uint32_t* hops;
+    uint64_t num_access;
+    uint64_t num_groups;
+    uint64_t num_segments;
+    uint64_t num_hops;
+
+    void* map_addr;
+    size_t map_size;
+    void unmap();
+    void setView();
+
+    template<typename F> void forEachMatch(uint32_t, uint32_t, F) const;
+    struct GroupResult {     // filled by one worker, hop offsets relative to 'hops'
+        std::vector<SegmentEntry> segments;
+        std::vector<uint32_t> hops;
+    };
+
+    static void collectSegments(const Topology&, uint32_t, std::vector<uint32_t>&, GroupResult&);
+};
+
+} //namespace
+
+#endif
@@ -5,10 +5,10 @@
 #include <omnetpp.h>
 #include "General.h"
 
-std::unordered_map<std::string, std::unordered_map<std::string, std::pair<std::string, int>>> system_layout;
+Topology system_topology;
 std::vector<std::string> all_oss, all_cn;
-std::vector<std::vector<std::string>> path_cn_cn, path_cn_oss;
-std::unordered_map<std::string, std::unordered_map<std::string, std::vector<std::vector<std::string>>>> all_paths;
+RouteService system_routes;
+RequestPool request_pool;
 
 using namespace omnetpp;
 
@@ -33,10 +33,7 @@ class Sink : public cSimpleModule
     virtual void handleMessage(cMessage *msg);
     virtual void finish();
   private:
-    void findPathCNtoCN(std::string, std::string, std::string, std::vector<std::string>&);
-    void findPathCNtoOSS(std::string, std::string, std::string, std::vector<std::string>&);
-    bool checkPath(const std::vector<std::string>&);
-    void generateShortPaths(std::vector<std::vector<std::string>>&);
+    uint64_t routeCacheKey();
 };
 
 }; // namespace
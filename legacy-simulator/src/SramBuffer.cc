@@ -0,0 +1,47 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "SramBuffer.h"
+
+namespace fattreenew {
+
+Define_Module(SramBuffer);
+
+void SramBuffer::initialize(int stage)
+{
+    Buffer::initialize(stage);
+    if(stage != 0)
+        return;
+
+    setMemory("SRAM_buffer", "read_SRAM_buffer_bw", "write_SRAM_buffer_bw");
+
+    payload_gate = -1;
+    for(int i=0; i<gateSize("port$o"); i++){
+        if(strcmp(gate("port$o", i)->getNextGate()->getOwnerModule()->getNedTypeName(), "fattreenew.Payload") == 0)
+            payload_gate = i;
+    }
+    if(payload_gate == -1)
+        throw cRuntimeError("%s is not connected to a payload!\n", getFullPath().c_str());
+}
+
+bool SramBuffer::canAdmit(Request* req) {
+    return hasRoom(MTU);
+}
+
+void SramBuffer::forward(Request* req) {
+    send(req, "port$o", payload_gate);
+}
+
+} //namespace
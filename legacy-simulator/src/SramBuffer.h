@@ -0,0 +1,39 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef __FATTREENEW_SRAMBUFFER_H_
+#define __FATTREENEW_SRAMBUFFER_H_
+
+#include "Buffer.h"
+
+namespace fattreenew {
+
+/**
+ * SRAM of an HCA or HBA. Takes a request while an MTU still fits and hands
+ * it back to the card's payload.
+ */
+class SramBuffer : public Buffer
+{
+  protected:
+    virtual void initialize(int stage) override;
+    virtual bool canAdmit(Request*) override;
+    virtual void forward(Request*) override;
+  private:
+    int payload_gate;
+};
+
+} //namespace
+
+#endif
@@ -21,19 +21,16 @@ Define_Module(StorageDevice);
 
 StorageDevice::StorageDevice(){}
 
-StorageDevice::~StorageDevice(){
-    while(!storage_queue->isEmpty()){
-        delete(storage_queue->pop());
-    }
-}
+StorageDevice::~StorageDevice(){}
 
 void StorageDevice::initialize()
 {
     queue_full = false;
-    storage_queue = new cQueue("storageQueue");
-    storage_queue->setup(comp);
+    occupancy.clear();
+    last_leave_time = SIMTIME_ZERO;
 
     qLenSignal = registerSignal("queueLength");
+    diskFreeSignal = registerSignal("diskFree");
 }
 
 void StorageDevice::handleMessage(cMessage *msg)
@@ -42,31 +39,36 @@ void StorageDevice::handleMessage(cMessage *msg)
     Request* req = check_and_cast<Request*>(msg);
 
     if(!msg->isSelfMessage()){
-        emit(qLenSignal, storage_queue->getLength());
+        emit(qLenSignal, (int)occupancy.getPackets());
         int gate_id(intuniform(0, gateSize("port$o")-1, 0));  // randomly select a channel
         req->setPort_index(gate_id);
         req->setArriveModule_time(simTime());
         updateMsgProcTime(req);
-        scheduleAt(req->getLeaveModule_time(), req->dup());
-        storage_queue->insert(req);
+        // the request itself is scheduled for departure and counted as queued until then
+        occupancy.add((int64_t)req->getFrag_size() * req->getFrag_count());
+        last_leave_time = req->getLeaveModule_time();
+        scheduleAt(req->getLeaveModule_time(), req);
     }else{
-        delete(storage_queue->pop()); // send the copy of scheduled msg above, so pop one in queue.
+        occupancy.remove((int64_t)req->getFrag_size() * req->getFrag_count());
         cGate* g = gate("port$o", req->getPort_index());
         simtime_t new_del_time = transTimestampByCable(g);
         sendDelayed(req, new_del_time-simTime(), "port$o", req->getPort_index());
     }
 
-    if(storage_queue->getLength() == par("max_queue_len").intValue())
+    bool was_full = queue_full;
+    if((int)occupancy.getPackets() == par("max_queue_len").intValue())
         queue_full = true;
-    else if(storage_queue->getLength() < par("max_queue_len").intValue())
+    else if((int)occupancy.getPackets() < par("max_queue_len").intValue())
         queue_full = false;
 //    else
 //        cRuntimeError("queue length out of control in %s\n", getFullName());
+    if(queue_full != was_full)
+        emit(diskFreeSignal, !queue_full);
 }
 
 void StorageDevice::updateMsgProcTime(Request* req) {
     if(req->getWork_type() == 'r'){
-        req->setByteLength(req->getFrag_size());
+        req->setByteLength((int64_t)req->getFrag_size() * req->getFrag_count());
     }else if(req->getWork_type() == 'w'){
         req->setByteLength(0);
     }else{
@@ -76,23 +78,26 @@ void StorageDevice::updateMsgProcTime(Request* req) {
     double proc_time;
     if(req->getWork_type() == 'r'){
         proc_time = 8.0 / par("read_bw").doubleValue();
-        proc_time = proc_time * (req->getFrag_size() / (double)MB );
+        proc_time = proc_time * ((double)req->getFrag_size() * req->getFrag_count() / MB ); // a train is served back to back
     }else{
         proc_time = 8.0 / par("write_bw").doubleValue();
-        proc_time = proc_time * (req->getFrag_size() / (double)MB );
+        proc_time = proc_time * ((double)req->getFrag_size() * req->getFrag_count() / MB ); // a train is served back to back
     }
 
-    if(storage_queue->getLength() < par("parallel_level").intValue()){
+    if((int)occupancy.getPackets() < par("parallel_level").intValue()){
         req->setLeaveModule_time(req->getArriveModule_time() + proc_time);
     }else{
-        auto last_req = check_and_cast<Request*>(storage_queue->back());
-        req->setLeaveModule_time(last_req->getLeaveModule_time() + proc_time);
+        req->setLeaveModule_time(last_leave_time + proc_time);
     }
 
     req->setFinished(true);
     req->setProc_time(proc_time);
 }
 
+void StorageDevice::finish() {
+    occupancy.recordScalars(this, "queue");
+}
+
 const bool StorageDevice::isFree() {
     return !queue_full;
 }
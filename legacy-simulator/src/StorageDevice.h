@@ -35,10 +35,13 @@ class StorageDevice : public cSimpleModule
   protected:
     virtual void initialize() override;
     virtual void handleMessage(cMessage *msg);
+    virtual void finish() override;
     simsignal_t qLenSignal;
+    simsignal_t diskFreeSignal;  // emitted when queue_full changes
   private:
     bool queue_full;
-    cQueue* storage_queue;
+    OccupancyTracker occupancy;  // requests scheduled for departure, each one its own self-message
+    simtime_t last_leave_time;   // of the most recently queued request
     void updateMsgProcTime(Request*);
 };
 
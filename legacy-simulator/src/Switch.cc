@@ -19,19 +19,50 @@ namespace fattreenew {
 
 Define_Module(Switch);
 
-Switch::Switch(){
-    switch_buffer = new cQueue(getFullName());
-}
+Switch::Switch(){}
 
 Switch::~Switch(){
 //    conn_map.clear();
-    while(!switch_buffer->isEmpty()){
-        delete(switch_buffer->pop());
-    }
+    for(auto& out:ports)
+        delete out.voq;
 }
 
-void Switch::initialize()
+void Switch::initialize(int stage)
 {
+    if(stage == 1){ // sink[0] builds the system topology in stage 0
+        buildFib();
+        // InfiniBand-style credits: the switch across the bundle on a port advertises its input
+        // buffer for that bundle, and gets the credits back from this switch
+        upstream_of.assign(gateSize("port$o"), std::make_pair((Switch*)nullptr, -1));
+        for(int i=0; i<gateSize("port$o"); i++){
+            int far_port;
+            Switch* far = switchBehind(i, far_port);
+            if(!far)
+                continue;
+            ports[i].credits = ports[i].credit_limit = far->par("port_buffer").intValue();
+            upstream_of[i] = std::make_pair(far, far_port);
+        }
+        return;
+    }
+
+    occupancy.clear();
+    credit_stalls = 0;
+    reroutes = 0;
+    proc_num = par("proc_num").intValue();
+    proc_latency = par((std::string(getName()) + "_latency").c_str()).doubleValue();
+    path_policy = parsePathPolicy(par("path_policy").stringValue());
+
+    ports.resize(gateSize("port$o"));
+    for(int i=0; i<gateSize("port$o"); i++){
+        ports[i].voq = new cQueue(("voq-" + std::to_string(i)).c_str());
+        ports[i].in_service = 0;
+        ports[i].credits = ports[i].credit_limit = INT64_MAX; // set from the downstream switch in stage 1
+
+        std::string signal_name = "portOccupancy" + std::to_string(i);
+        ports[i].occupancy_signal = registerSignal(signal_name.c_str());
+        getEnvir()->addResultRecorders(this, ports[i].occupancy_signal, signal_name.c_str(),
+                getProperties()->get("statisticTemplate", "portOccupancy"));
+    }
 
 //    queueIsFull = false;
     qLenSignal = registerSignal("queueLen");
@@ -45,341 +76,207 @@ void Switch::handleMessage(cMessage *msg)
     int gate_id;
 
     if(!msg->isSelfMessage()) { // if new msg arrives here
+        // the forwarding table picks the port, and the request's route follows that choice
+        char direction = hasPath(req, 's') ? 's' : 'b';
+        gate_id = forwardTo(direction == 's' ? req->getDes_addr() : req->getSrc_addr(), req);
+        gate_id = followRoute(req, direction, gate_id);
+
+        emit(qLenSignal, geatRealQueueLength());
+        req->setArriveModule_time(simTime());
+        req->setPort_index(gate_id);
+        req->setProc_time(req->getByteLength() ? proc_latency : 0.0);
+
+        // the input buffer space goes back to the upstream switch once the request leaves
+        int in_port = req->getArrivalGate()->getIndex();
+        if(upstream_of[in_port].first && req->getByteLength())
+            credit_owners[req] = upstream_of[in_port];
+
+        OutputPort& out = ports[gate_id];
+        occupancy.add(req->getByteLength());
+        out.load.add(req->getByteLength());
+        emit(out.occupancy_signal, (intval_t)out.load.getBytes());
+        out.voq->insert(req);
+        serve(gate_id);
+    } else {  // processing done, the request leaves through its output port
+        int port = req->getPort_index();
+        OutputPort& out = ports[port];
+        out.in_service--;
+        out.load.remove(req->getByteLength());
+        emit(out.occupancy_signal, (intval_t)out.load.getBytes());
+        occupancy.remove(req->getByteLength());
+        returnUpstreamCredit(req);
+
+        simtime_t new_del_time = transTimestampByCable(gate("port$o", port));
+        std::string next_gate_name = gate("port$o", port)->getNextGate()->getOwnerModule()->getName();
+        if(strcmp(next_gate_name.c_str(), "cn") && strcmp(next_gate_name.c_str(), "mds")) // if not sent to CN or MDS
+            emit(staySignal, (new_del_time-req->getArriveModule_time()).dbl());
+        emit(waitingSignal, (new_del_time-req->getArriveModule_time()).dbl() - req->getProc_time());
+        sendDelayed(req, new_del_time-simTime(), "port$o", port);
 
-        if(strcmp(getName(), "edge") == 0){  // At Edge layer
-            if(std::regex_match(req->getMaster_id_addr(), std::regex("cn\\[[0-9]+\\]")) &&
-                    (!req->getCkp_launched() || req->getFinished())){
-                if(!req->getCkp_launched()){
-                    if(conn_map.count(req->getDes_addr()))
-                        gate_id = conn_map[req->getDes_addr()];
-                    else
-                        gate_id = randChoose("aggr");
-                }else{
-                    if(conn_map.count(req->getSrc_addr()))
-                        gate_id = conn_map[req->getSrc_addr()];
-                    else
-                        gate_id = randChoose("aggr");
-                }
-            }else{
-                if(std::regex_match(req->getDes_addr(), std::regex("cn\\[[0-9]+\\]"))){ // destination is another CN
-                    if(req->getFinished()){ // returned from destination CN
-                        if(conn_map.count(req->getSrc_addr()))
-                            gate_id = conn_map[req->getSrc_addr()];
-                        else
-                            gate_id = randChoose("aggr");
-                    }else if(conn_map.count(req->getDes_addr())){
-                        gate_id = conn_map[req->getDes_addr()];
-                    }else{
-                        gate_id = randChoose("aggr");
-                    }
-                }else{ // destination is OST
-                    if(req->getWork_type() == 'r'){
-                        if(req->getByteLength()){ // read data from ost
-                            gate_id = conn_map[req->getSrc_addr()];
-                        }else{
-                            gate_id = randChoose("aggr");
-                        }
-                    }else{
-                        if(req->getByteLength()){ // write data to ost
-                            gate_id = randChoose("aggr");
-                        }else{                             // have written data to ost
-                            gate_id = conn_map[req->getSrc_addr()];
-                        }
-                    }
-                }
-            }
-
-        }else if(strcmp(getName(), "aggr") == 0){  // At Aggregation layer
-            if(std::regex_match(req->getMaster_id_addr(), std::regex("cn\\[[0-9]+\\]")) &&
-                    (!req->getCkp_launched() || req->getFinished())){
-                if(!req->getCkp_launched()){
-                    int forward_to_dest_id = findCN(req->getDes_addr(), "edge");
-//                    if(strcmp(req->getSenderModule()->getName(), "edge") == 0 || forward_to_dest_id==-1)
-                    if(forward_to_dest_id == -1)
-                        gate_id = randChoose("core");
-                    else
-                        gate_id = forward_to_dest_id;
-                }else{
-                    int back_to_src_id = findCN(req->getSrc_addr(), "edge");
-                    if(back_to_src_id == -1)
-                        gate_id = randChoose("core");
-                    else
-                        gate_id = back_to_src_id;
-                }
-            }else{
-            if(std::regex_match(req->getDes_addr(), std::regex("cn\\[[0-9]+\\]"))){ // destination is another CN
-                if(strcmp(req->getSenderModule()->getName(), "edge") == 0){ // from Edge layer
-                    int back_to_src_id = findCN(req->getSrc_addr(), "edge");
-                    int forward_to_dest_id = findCN(req->getDes_addr(), "edge");
-                    if(!req->getFinished()) { // if has not arrived target CN
-                        if(forward_to_dest_id == -1)
-                            gate_id = randChoose("core");
-                        else
-                            gate_id = forward_to_dest_id;
-                    }else{
-                        if(back_to_src_id == -1)
-                            gate_id = randChoose("core");
-                        else
-                            gate_id = back_to_src_id;
-                    }
-                }else if(strcmp(req->getSenderModule()->getName(), "core") == 0){ // from Core layer
-                    if(!req->getFinished())
-                        gate_id = findCN(req->getDes_addr(), "edge");
-                    else
-                        gate_id = findCN(req->getSrc_addr(), "edge");
-                }else{
-                    throw cRuntimeError("Aggr layer connected with other unknown switches!\n");
-                }
-            }else{
-                if(strcmp(req->getSenderModule()->getName(), "edge") == 0){ // from Edge layer
-                    gate_id = randChoose("core");
-                }else if(strcmp(req->getSenderModule()->getName(), "core") == 0){ // from Core layer
-                    gate_id = findCN(req->getSrc_addr(), "edge");
-                }else{
-                    throw cRuntimeError("Aggr layer connected with other unknown switches!\n");
-                }
-            }
-          }
-
-        }else if(strcmp(getName(), "core") == 0){  // At Core layer
-            if(std::regex_match(req->getMaster_id_addr(), std::regex("cn\\[[0-9]+\\]")) &&
-                    !req->getCkp_launched()){
-                gate_id = findAggr(req->getDes_addr());
-            }else{
-            if(std::regex_match(req->getDes_addr(), std::regex("cn\\[[0-9]+\\]"))){ // destination is another CN
-                if(!req->getFinished())
-                    gate_id = findAggr(req->getDes_addr());
-                else
-                    gate_id = findAggr(req->getSrc_addr());
-            }else{
-                if(strcmp(req->getSenderModule()->getName(), "aggr") == 0){
-                    if(!conn_map.count("mds"))
-                        throw cRuntimeError("No MDS %s exists!\n", req->getNext_hop_addr());
-                    gate_id = conn_map["mds"];
-                }else if(strcmp(req->getSenderModule()->getName(), "mds") == 0){
-                    if(!conn_map.count(req->getNext_hop_addr()))
-                        throw cRuntimeError("%s No such OSS %s exists!\n", getFullName(), req->getNext_hop_addr());
-                    gate_id  = conn_map[req->getNext_hop_addr()];
-                }else if(strcmp(req->getSenderModule()->getName(), "oss") == 0){
-                    gate_id  = findAggr(req->getSrc_addr());
-                    if(gate_id == -1)
-                        throw cRuntimeError("Cannot assign gate from core switches to aggr");
-                }else{
-                    throw cRuntimeError("Core layer connected with other unknown switches!\n");
-                }
-            }
-                       }
-
-        }else{
-            throw cRuntimeError("Unknown switch appears!\n");
-        }
-
-        double proc_time(0.0);
-        if(strcmp(getName(), "core") || strcmp(req->getSenderModule()->getName(), "aggr") ||
-                                       std::regex_match(req->getDes_addr(), std::regex("cn\\[[0-9]+\\]"))){
-            emit(qLenSignal, geatRealQueueLength());
-            req->setArriveModule_time(simTime());
-            req->setPort_index(gate_id);
-            simtime_t del_time = simTime();
-//            if(gate("port$o", gate_id)->getChannel()->isTransmissionChannel())
-//                del_time = std::max(gate("port$o", gate_id)->getTransmissionChannel()->getTransmissionFinishTime(), simTime());
-
-            if(switch_buffer->getLength() < par("proc_num").intValue()){
-                if(strcmp(getName(), "core") == 0) {
-                    if(req->getByteLength()){
-                        proc_time = par("core_latency").doubleValue();
-                        req->setLeaveModule_time(del_time + proc_time);
-                    }else{
-                        req->setLeaveModule_time(del_time);
-                    }
-                }else if(strcmp(getName(), "aggr") == 0) {
-                    if(req->getByteLength()){
-                        proc_time = par("aggr_latency").doubleValue();
-                        req->setLeaveModule_time(del_time + proc_time);
-                    }else{
-                        req->setLeaveModule_time(del_time);
-                    }
-                }else if(strcmp(getName(), "edge") == 0) {
-                    if(req->getByteLength()){
-                        proc_time = par("edge_latency").doubleValue();
-                        req->setLeaveModule_time(del_time + proc_time);
-                    }else{
-                        req->setLeaveModule_time(del_time);
-                    }
-                }
-            }else{
-                auto last_req = check_and_cast<Request*>(switch_buffer->back());
-                if(strcmp(getName(), "core") == 0) {
-                    if(req->getByteLength()){
-                        proc_time = par("core_latency").doubleValue();
-                        req->setLeaveModule_time(last_req->getLeaveModule_time() + proc_time);
-                    }else{
-                        req->setLeaveModule_time(last_req->getLeaveModule_time());
-                    }
-                }else if(strcmp(getName(), "aggr") == 0) {
-                    if(req->getByteLength()){
-                        proc_time = par("aggr_latency").doubleValue();
-                        req->setLeaveModule_time(last_req->getLeaveModule_time() + proc_time);
-                    }else{
-                        req->setLeaveModule_time(last_req->getLeaveModule_time());
-                    }
-                }else if(strcmp(getName(), "edge") == 0) {
-                    if(req->getByteLength()){
-                        proc_time = par("edge_latency").doubleValue();
-                        req->setLeaveModule_time(last_req->getLeaveModule_time() + proc_time);
-                    }else{
-                        req->setLeaveModule_time(last_req->getLeaveModule_time());
-                    }
-                }
-            }
+        serve(port);
+    }
 
-            req->setProc_time(proc_time);
-            scheduleAt(req->getLeaveModule_time(), req->dup());
-            switch_buffer->insert(req);
-        }else{ // core to mds and need goes to OST
-            if(req->getByteLength()){
-                proc_time = par("core_latency").doubleValue();
-                sendDelayed(req, proc_time, "port$o", gate_id);
-            }else{
-                send(req, "port$o", gate_id);
-            }
-            req->setProc_time(proc_time);
-        }
+}
 
-    } else {  // if self-message re-enter the queue
-        delete(switch_buffer->pop()); // scheduled sending a copy above
-        simtime_t new_del_time = simTime();
-        if(gate("port$o", req->getPort_index())->getChannel()->isTransmissionChannel())
-            new_del_time = std::max(gate("port$o", req->getPort_index())->getTransmissionChannel()->getTransmissionFinishTime(), simTime());
-
-        std::string next_gate_name = gate("port$o", req->getPort_index())->getNextGate()->getOwnerModule()->getName();
-        if(strcmp(next_gate_name.c_str(), "cn") && strcmp(next_gate_name.c_str(), "mds")){ // if not sent to CN or MDS
-            if(strcmp(next_gate_name.c_str(), "oss") == 0){
-                //                OSS* next_oss = check_and_cast<OSS*>(gate("port$o", req->getPort_index())->getNextGate()->getOwnerModule());
-                //                if(!next_oss->queueIsFull){
-                sendDelayed(req, new_del_time-simTime(), "port$o", req->getPort_index());
-                emit(staySignal, (new_del_time-req->getArriveModule_time()).dbl());
-                //                }else
-                //                    delete req;
-            }else{
-                //                Switch* next_sw = check_and_cast<Switch*>(gate("port$o", req->getPort_index())->getNextGate()->getOwnerModule());
-                //                if(!next_sw->queueIsFull){
-                sendDelayed(req, new_del_time-simTime(), "port$o", req->getPort_index());
-                emit(staySignal, (new_del_time-req->getArriveModule_time()).dbl());
-                //                }else
-                //                    delete req;
-            }
-        }else{
-            sendDelayed(req, new_del_time-simTime(), "port$o", req->getPort_index());
+void Switch::serve(int port){
+    // the head of the port's VOQ starts once a service slot is free and the downstream buffer can take it
+    OutputPort& out = ports[port];
+    while(!out.voq->isEmpty() && out.in_service < proc_num){
+        Request* head = check_and_cast<Request*>(out.voq->front());
+        int64_t bytes = head->getByteLength();
+        if(bytes > out.credits && out.credits < out.credit_limit){ // a request larger than the whole buffer may go when it is empty
+            credit_stalls++;
+            break;
         }
-
-        emit(waitingSignal, (new_del_time-req->getArriveModule_time()).dbl() - req->getProc_time());
+        out.voq->pop();
+        out.credits -= bytes;
+        out.in_service++;
+        head->setLeaveModule_time(simTime() + head->getProc_time());
+        scheduleAt(head->getLeaveModule_time(), head);
     }
+}
 
+void Switch::returnCredit(int port, int64_t bytes){
+    Enter_Method_Silent();
+    ports[port].credits += bytes;
+    serve(port);
 }
 
-void Switch::finish(){}
+void Switch::returnUpstreamCredit(Request* req){
+    auto it = credit_owners.find(req);
+    if(it == credit_owners.end())
+        return;
+    it->second.first->returnCredit(it->second.second, req->getByteLength());
+    credit_owners.erase(it);
+}
 
-int Switch::randChoose(std::string layer){ // Randomly select a switch following uniform distribution, to core or aggr layer
-    std::vector<int> all_gates;
-    for(auto item:conn_map){
-        if (std::regex_match(item.first, std::regex(layer+"\\[[0-9]+\\]"))){
-            all_gates.push_back(item.second);
-//            Switch* sw = check_and_cast<Switch*>(gate("port$o", item.second)->getNextGate()->getOwnerModule());
-//            queue_data_size[item.second] = sw->getDataSizeInQueue();
-        }
+Switch* Switch::switchBehind(int port, int& far_port){
+    // the other switch connected to the bundle on this port, and its port to the bundle
+    cModule* bundle = gate("port$o", port)->getNextGate()->getOwnerModule();
+    for(int i=0; bundle->hasGate("port$o") && i<bundle->gateSize("port$o"); i++){
+        Switch* far = dynamic_cast<Switch*>(bundle->gate("port$o", i)->getNextGate()->getOwnerModule());
+        if(!far || far == this)
+            continue;
+        far_port = system_topology.findGate(system_topology.getId(far->getFullName()), port_neighbor[port]);
+        if(far_port == Topology::NO_GATE)
+            throw cRuntimeError("%s is not in the system topology!\n", far->getFullName());
+        return far;
     }
+    return nullptr;
+}
 
-    if(all_gates.empty())
-        throw cRuntimeError("Cannot find available hop station at %s", getName());
-
-    return all_gates[intuniform(0, all_gates.size()-1, 0)];
+void Switch::finish(){
+    recordScalar("creditStalls", credit_stalls);
+    recordScalar("reroutes", reroutes);
+    occupancy.recordScalars(this, "queue");
+}
 
-    // belowing part tries to select the least data size in queue
-    int64_t min_data_size(INT64_MAX);
-    int dest_port(INT_MIN);
+void Switch::buildFib(){
+    node_id = system_topology.getId(getFullName());
+    if(node_id == Topology::NO_NODE)
+        throw cRuntimeError("%s is not in the system topology!\n", getFullName());
+    int rank = RouteTable::switchRank(system_topology.getKind(node_id));
+
+    // every node reachable from a lower neighbor without climbing back up is a destination behind that port
+    std::vector<std::vector<int>> ports_to(system_topology.getNumNodes());
+    port_neighbor.resize(gateSize("port$o"));
+    for(int i=0; i<gateSize("port$o"); i++){
+        uint32_t neighbor = system_topology.getId(gate("port$o", i)->getNextGate()->getOwnerModule()->getFullName());
+        conn_map[neighbor] = i;
+        port_neighbor[i] = neighbor;
+        NodeKind kind = system_topology.getKind(neighbor);
+        if(kind == NODE_SINK)
+            continue;
+        if(RouteTable::switchRank(kind) > rank){
+            up_ports.push_back(i);
+            continue;
+        }
 
-    for(int port_ind:all_gates){
-        if(queue_data_size[port_ind] <= min_data_size){
-            min_data_size = queue_data_size[port_ind];
-            dest_port = port_ind;
+        std::vector<bool> seen(system_topology.getNumNodes(), false);
+        std::vector<uint32_t> stack(1, neighbor);
+        seen[node_id] = true;
+        seen[neighbor] = true;
+        while(!stack.empty()){
+            uint32_t cur = stack.back();
+            stack.pop_back();
+            ports_to[cur].push_back(i);
+            int cur_rank = RouteTable::switchRank(system_topology.getKind(cur));
+            for(auto it=system_topology.neighborsBegin(cur); it!=system_topology.neighborsEnd(cur); it++){
+                NodeKind next_kind = system_topology.getKind(*it);
+                if(!seen[*it] && next_kind != NODE_SINK && RouteTable::switchRank(next_kind) <= cur_rank){
+                    seen[*it] = true;
+                    stack.push_back(*it);
+                }
+            }
         }
     }
 
-    return dest_port;
+    // destinations under the same ports share one set
+    std::map<std::vector<int>, int32_t> set_index;
+    fib.assign(system_topology.getNumNodes(), -1);
+    for(uint32_t node=0; node<ports_to.size(); node++){
+        if(ports_to[node].empty())
+            continue;
+        auto ins = set_index.emplace(ports_to[node], (int32_t)down_sets.size());
+        if(ins.second)
+            down_sets.push_back(ports_to[node]);
+        fib[node] = ins.first->second;
+    }
 }
 
-bool Switch::checkPort(std::string port_name){
-    return conn_map.count(port_name);
+int Switch::choosePort(const std::vector<int>& candidates, Request* req){
+    return candidates[choosePath(this, path_policy, candidates.size(), flowHash(req, node_id), 0, [&](uint32_t i){ return ports[candidates[i]].load.getBytes(); })];
 }
 
-int Switch::findCN(std::string src, std::string layer){ // find compute node from Aggr layer
-    for(auto item:conn_map){
-        if (std::regex_match(item.first, std::regex(layer+"\\[[0-9]+\\]"))){
-            cGate* g = gate("port$o", item.second);
-            if(layer == "edge"){
-                Switch* sw = check_and_cast<Switch*>(g->getNextGate()->getOwnerModule()); // get edge switch
-                if(sw->checkPort(src))  // check if corresponding CN connected
-                    return item.second;
-            }else if(layer == "oss"){
-//                OSS* oss = check_and_cast<OSS*>(g->getNextGate()->getOwnerModule()); // get oss
-//                if(oss->findOST(src))  // check if corresponding ost connected
-//                    return item.second;
-            }
-        }
-    }
+int Switch::randChoose(Request* req){ // select a port towards the layer above by path_policy
+    if(up_ports.empty())
+        throw cRuntimeError("Cannot find available hop station at %s", getName());
 
-    return -1;
+    return choosePort(up_ports, req);
 }
 
-int Switch::findAggr(std::string src){ // for core switch find OST under aggr. switch
-    std::vector<int> avail_aggr;
-    for(auto item:conn_map){
-        if (std::regex_match(item.first, std::regex("aggr\\[[0-9]+\\]"))){
-            cGate* g = gate("port$o", item.second);
-            Switch* sw = check_and_cast<Switch*>(g->getNextGate()->getOwnerModule()); // get aggr switch
-            if(sw->findCN(src, "edge") != -1){
-                avail_aggr.push_back(item.second);
-                queue_data_size[item.second] = sw->getDataSizeInQueue();
-            }
-        }
-    }
+bool Switch::checkPort(uint32_t node){
+    return conn_map.count(node);
+}
 
-    if(avail_aggr.empty())
-        throw cRuntimeError("Cannot find available Aggr. Switch at %s", getName());
+int Switch::findDown(uint32_t des, Request* req){ // port towards a node below this switch, -1 if it is not below
+    if(des >= fib.size() || fib[des] < 0)
+        return -1;
 
-    return avail_aggr[intuniform(0, avail_aggr.size()-1, 0)];
+    return choosePort(down_sets[fib[des]], req);
+}
 
-    int64_t min_data_size(INT64_MAX);
-    int dest_port(INT_MIN);//(avail_aggr[intuniform(0, avail_aggr.size()-1, 0)]);
+int Switch::forwardTo(uint32_t des, Request* req){ // down if the node is below this switch, otherwise up
+    int port = findDown(des, req);
+    return port == -1 ? randChoose(req) : port;
+}
 
-    for(int port_ind:avail_aggr){
-        if(queue_data_size[port_ind] <= min_data_size){
-            min_data_size = queue_data_size[port_ind];
-            dest_port = port_ind;
-        }
+int Switch::followRoute(Request* req, char direction, int port){
+    // The modules behind this switch read their next hops from the request's route, so the
+    // route is moved onto an equal-cost one through the chosen port. The route chosen at the
+    // source is kept if none exists. The load stays on the source's choice (load_route).
+    uint32_t route_id = direction == 's' ? req->getSend_route() : req->getBack_route();
+    unsigned hop = direction == 's' ? req->getSend_hop() : req->getBack_hop();
+    uint32_t new_route = system_routes.rerouteVia(route_id, hop, port_neighbor[port]);
+    if(new_route != RouteService::NO_ROUTE && new_route != route_id){
+        system_routes.pinRoute(new_route);
+        system_routes.unpinRoute(route_id);
+        direction == 's' ? req->setSend_route(new_route) : req->setBack_route(new_route);
+        reroutes++;
     }
 
-    return dest_port;
+    uint32_t next = popPath(req, direction);
+    if(!conn_map.count(next))
+        throw cRuntimeError("%s is not connected to the next hop %s!\n", getFullName(), system_topology.getName(next).c_str());
+    return conn_map[next];
 }
 
 int Switch::geatRealQueueLength(){
-    int len(0);
-    for (cQueue::Iterator iter(*switch_buffer); !iter.end(); iter++) {
-        Request* req = check_and_cast<Request*>(*iter);
-        if(req->getByteLength())
-            len++;
-    }
-    return len;
+    return occupancy.getDataPackets();
 }
 
 uint64_t Switch::getDataSizeInQueue(){
-    uint64_t total_size(0);
-    for (cQueue::Iterator iter(*switch_buffer); !iter.end(); iter++) {
-        Request* req = check_and_cast<Request*>(*iter);
-        total_size += req->getByteLength(); // Actual data size
-    }
-    return total_size;
+    return occupancy.getBytes(); // Actual data size
 }
 
 }// namespace
@@ -28,22 +28,55 @@ class Switch : public cSimpleModule
   public:
     Switch();
     virtual ~Switch();
-    bool checkPort(std::string);
+    bool checkPort(uint32_t);
+    void returnCredit(int, int64_t);
 //    bool queueIsFull;
     uint64_t getDataSizeInQueue();
   protected:
     std::map<int, int64_t> queue_data_size; // <port, data_size_in_queue>
-    std::unordered_map<std::string, int> conn_map;
-    cQueue* switch_buffer;
+    std::unordered_map<uint32_t, int> conn_map; // <node ID, port> of the direct neighbors
+    // forwarding table: ECMP set towards the layer above, and per destination the ports leading down to it
+    uint32_t node_id;
+    std::vector<uint32_t> port_neighbor;        // node ID behind each output port
+    std::vector<int> up_ports;
+    std::vector<std::vector<int>> down_sets;    // distinct down-path port sets
+    std::vector<int32_t> fib;                   // node ID -> index into down_sets, -1 if not below this switch
+    PathPolicy path_policy;
+
+    // virtual output queues: one per output port, gated by credits for the downstream input buffer
+    struct OutputPort {
+        cQueue* voq;           // waiting for a service slot or for credits
+        int in_service;
+        int64_t credits;       // bytes the downstream buffer can still take
+        int64_t credit_limit;  // its whole buffer, INT64_MAX if no Switch is behind the port
+        OccupancyTracker load; // queued or in service
+        simsignal_t occupancy_signal;
+    };
+    std::vector<OutputPort> ports;
+    std::vector<std::pair<Switch*, int>> upstream_of;                    // by input port: the switch sending through it, and its output port
+    std::unordered_map<Request*, std::pair<Switch*, int>> credit_owners; // upstream switch and port to give the buffer back to
+    int proc_num;              // requests in service per output port
+    double proc_latency;
+    uint64_t credit_stalls;
+    uint64_t reroutes;         // requests moved onto another equal-cost route
+    // totals over all ports; a request in service is the scheduled self-message itself
+    OccupancyTracker occupancy;
     simsignal_t qLenSignal;
     simsignal_t staySignal;
     double waitingSignal;
-    virtual void initialize();
+    virtual int numInitStages() const override { return 2; }
+    virtual void initialize(int stage) override;
     virtual void handleMessage(cMessage *msg);
     virtual void finish();
-    virtual int randChoose(std::string);
-    virtual int findCN(std::string, std::string);
-    virtual int findAggr(std::string);
+    void buildFib();
+    void serve(int);
+    void returnUpstreamCredit(Request*);
+    Switch* switchBehind(int, int&);
+    int choosePort(const std::vector<int>&, Request*);
+    virtual int randChoose(Request*);
+    virtual int findDown(uint32_t, Request*);
+    int forwardTo(uint32_t, Request*);
+    int followRoute(Request*, char, int);
     int geatRealQueueLength();
 };
 
@@ -0,0 +1,48 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "SwitchBuffer.h"
+
+namespace fattreenew {
+
+Define_Module(SwitchBuffer);
+
+void SwitchBuffer::initialize(int stage)
+{
+    Buffer::initialize(stage);
+    if(stage != 0)
+        return;
+
+    if(strcmp(par("memory").stringValue(), "sram") == 0)
+        setMemory("SRAM_buffer", "read_SRAM_buffer_bw", "write_SRAM_buffer_bw");
+    else if(strcmp(par("memory").stringValue(), "switch") == 0)
+        setMemory("switch_buffer", "read_switch_bw", "write_switch_bw");
+    else
+        throw cRuntimeError("Unknown switch memory %s!\n", par("memory").stringValue());
+}
+
+void SwitchBuffer::onArrival(Request* req) {
+    req->setNext_hop_addr(popPath(req, hasPath(req, 's') ? 's' : 'b'));
+}
+
+bool SwitchBuffer::canAdmit(Request* req) {
+    return hasRoom(MTU);
+}
+
+void SwitchBuffer::forward(Request* req) {
+    send(req, "port$o", getGateTo(req->getNext_hop_addr()));
+}
+
+} //namespace
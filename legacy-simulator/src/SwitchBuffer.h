@@ -0,0 +1,38 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef __FATTREENEW_SWITCHBUFFER_H_
+#define __FATTREENEW_SWITCHBUFFER_H_
+
+#include "Buffer.h"
+
+namespace fattreenew {
+
+/**
+ * Edge, aggregation or core switch of the fat-tree as a shared buffer. The
+ * next hop is read from the request's route when it arrives.
+ */
+class SwitchBuffer : public Buffer
+{
+  protected:
+    virtual void initialize(int stage) override;
+    virtual void onArrival(Request*) override;
+    virtual bool canAdmit(Request*) override;
+    virtual void forward(Request*) override;
+};
+
+} //namespace
+
+#endif
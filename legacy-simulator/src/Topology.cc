@@ -0,0 +1,126 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "Topology.h"
+#include <algorithm>
+
+namespace fattreenew {
+
+uint32_t Topology::intern(const std::string& name) {
+    auto it = name_to_id.find(name);
+    if(it != name_to_id.end())
+        return it->second;
+
+    uint32_t id = names.size();
+    names.push_back(name);
+    kinds.push_back(classify(name));
+    name_to_id[name] = id;
+    return id;
+}
+
+uint32_t Topology::getId(const std::string& name) const {
+    auto it = name_to_id.find(name);
+    return it == name_to_id.end() ? NO_NODE : it->second;
+}
+
+const std::string& Topology::getName(uint32_t id) const {
+    return names[id];
+}
+
+NodeKind Topology::classify(const std::string& name) {
+    std::string base = name.substr(0, name.find('['));
+
+    if(base == "cn") return NODE_CN;
+    if(base == "oss") return NODE_OSS;
+    if(base == "sink") return NODE_SINK;
+    if(base == "inif_edge_cn") return NODE_INIF_EDGE_CN;
+    if(base == "edge_connect") return NODE_EDGE_CONNECT;
+    if(base == "edge") return NODE_EDGE;
+    if(base == "inif_aggr_edge") return NODE_INIF_AGGR_EDGE;
+    if(base == "aggr") return NODE_AGGR;
+    if(base == "inif_core_aggr") return NODE_INIF_CORE_AGGR;
+    if(base == "core") return NODE_CORE;
+    return NODE_OTHER;
+}
+
+void Topology::addLink(uint32_t from, uint32_t to, GateKind kind, int gate_index) {
+    pending.push_back({from, to, gate_index, kind});
+}
+
+void Topology::finalize() {
+    // sort by (from, to); for duplicated pairs the link added last wins
+    std::stable_sort(pending.begin(), pending.end(), [](const PendingLink& a, const PendingLink& b){
+        return a.from < b.from || (a.from == b.from && a.to < b.to);
+    });
+
+    row_offsets.assign(names.size()+1, 0);
+    link_to.clear();
+    link_gate.clear();
+    link_kind.clear();
+
+    for(size_t i=0; i<pending.size(); i++){
+        if(i+1 < pending.size() && pending[i+1].from == pending[i].from && pending[i+1].to == pending[i].to)
+            continue;
+        row_offsets[pending[i].from+1]++;
+        link_to.push_back(pending[i].to);
+        link_gate.push_back(pending[i].gate_index);
+        link_kind.push_back(pending[i].gate_kind);
+    }
+    for(size_t i=1; i<row_offsets.size(); i++)
+        row_offsets[i] += row_offsets[i-1];
+
+    pending.clear();
+    pending.shrink_to_fit();
+}
+
+void Topology::clear() {
+    names.clear();
+    kinds.clear();
+    name_to_id.clear();
+    pending.clear();
+    row_offsets.clear();
+    link_to.clear();
+    link_gate.clear();
+    link_kind.clear();
+}
+
+int Topology::findGate(uint32_t from, uint32_t to, GateKind* kind) const {
+    if(!hasLinks(from))
+        return NO_GATE;
+
+    auto first = link_to.begin() + row_offsets[from];
+    auto last = link_to.begin() + row_offsets[from+1];
+    auto it = std::lower_bound(first, last, to);
+    if(it == last || *it != to)
+        return NO_GATE;
+
+    size_t pos = it - link_to.begin();
+    if(kind)
+        *kind = link_kind[pos];
+    return link_gate[pos];
+}
+
+uint64_t Topology::getFingerprint() const {
+    uint64_t hash = fnv1a(nullptr, 0);
+    for(auto& name:names)
+        hash = fnv1a(name.c_str(), name.size()+1, hash);
+    hash = fnv1a(row_offsets.data(), row_offsets.size()*sizeof(uint32_t), hash);
+    hash = fnv1a(link_to.data(), link_to.size()*sizeof(uint32_t), hash);
+    hash = fnv1a(link_gate.data(), link_gate.size()*sizeof(int32_t), hash);
+    hash = fnv1a(link_kind.data(), link_kind.size()*sizeof(GateKind), hash);
+    return hash;
+}
+
+} //namespace
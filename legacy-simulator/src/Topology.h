@@ -0,0 +1,109 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef __FATTREENEW_TOPOLOGY_H_
+#define __FATTREENEW_TOPOLOGY_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace fattreenew {
+
+// FNV-1a, used for topology fingerprints and cache keys
+inline uint64_t fnv1a(const void* data, size_t len, uint64_t hash=1469598103934665603ULL) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for(size_t i=0; i<len; i++){
+        hash ^= p[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+enum GateKind : uint8_t {
+    GATE_PORT_O, // "port$o"
+    GATE_OUT     // "out"
+};
+
+enum NodeKind : uint8_t {
+    NODE_CN,
+    NODE_OSS,
+    NODE_SINK,
+    NODE_INIF_EDGE_CN,
+    NODE_EDGE_CONNECT,
+    NODE_EDGE,
+    NODE_INIF_AGGR_EDGE,
+    NODE_AGGR,
+    NODE_INIF_CORE_AGGR,
+    NODE_CORE,
+    NODE_OTHER
+};
+
+/**
+ * Module graph of the network. Every module name is interned to a dense
+ * uint32 ID; links are kept as CSR arrays (row offsets, neighbor IDs,
+ * gate index and gate kind), each row sorted by neighbor ID.
+ */
+class Topology
+{
+  public:
+    static const uint32_t NO_NODE = UINT32_MAX;
+    static const int NO_GATE = INT32_MIN;
+
+    // name <-> ID lookup shared by all modules
+    uint32_t intern(const std::string&);
+    uint32_t getId(const std::string&) const;
+    const std::string& getName(uint32_t) const;
+    NodeKind getKind(uint32_t id) const { return kinds[id]; }
+    uint32_t getNumNodes() const { return names.size(); }
+    static NodeKind classify(const std::string&);
+
+    // construction: add links, then finalize() to build the CSR arrays
+    void addLink(uint32_t, uint32_t, GateKind, int);
+    void finalize();
+    void clear();
+
+    // adjacency
+    bool hasLinks(uint32_t id) const { return id != NO_NODE && id+1 < row_offsets.size(); } // false for NO_NODE and names interned after finalize()
+    uint32_t getDegree(uint32_t id) const { return hasLinks(id) ? row_offsets[id+1] - row_offsets[id] : 0; }
+    const uint32_t* neighborsBegin(uint32_t id) const { return link_to.data() + (hasLinks(id) ? row_offsets[id] : 0); }
+    const uint32_t* neighborsEnd(uint32_t id) const { return link_to.data() + (hasLinks(id) ? row_offsets[id+1] : 0); }
+    int findGate(uint32_t, uint32_t, GateKind* kind=nullptr) const; // NO_GATE if not connected
+
+    uint64_t getFingerprint() const; // hash over names and links; equal fingerprints mean equal node IDs
+
+  private:
+    struct PendingLink {
+        uint32_t from;
+        uint32_t to;
+        int32_t gate_index;
+        GateKind gate_kind;
+    };
+
+    std::vector<std::string> names;
+    std::vector<NodeKind> kinds;
+    std::unordered_map<std::string, uint32_t> name_to_id;
+    std::vector<PendingLink> pending;
+
+    std::vector<uint32_t> row_offsets;  // size getNumNodes()+1
+    std::vector<uint32_t> link_to;
+    std::vector<int32_t> link_gate;
+    std::vector<GateKind> link_kind;
+};
+
+} //namespace
+
+#endif
@@ -22,11 +22,13 @@ Define_Module(WorkGenerator);
 void WorkGenerator::initialize()
 {
     if(par("sendInitialMessage").boolValue()){
-        Request* req = new Request();
+        Request* req = request_pool.acquire();
         scheduleAt(simTime(), req);
     }
 
     id = 1;
+    path_policy = parsePathPolicy(par("path_policy").stringValue());
+    flow_engine = dynamic_cast<FlowEngine*>(getSystemModule()->getSubmodule("flowEngine"));
 }
 
 void WorkGenerator::initMsg(Request* req) {
@@ -44,7 +46,8 @@ void WorkGenerator::initMsg(Request* req) {
     }
 
     req->setGenerate_time(simTime());
-    req->setSrc_addr(getParentModule()->getFullName());
+    uint32_t src_id = system_topology.getId(getParentModule()->getFullName());
+    req->setSrc_addr(src_id);
 
     std::string des;
     double to_cn_prob(uniform(0, 1.0, par("rng").intValue()));
@@ -60,21 +63,31 @@ void WorkGenerator::initMsg(Request* req) {
         req->setTarget_ost(intuniform(0, num_ost-1, par("rng").intValue()));
     }
 
-    req->setDes_addr(des.c_str());
-    auto avail_paths = all_paths[req->getSrc_addr()][req->getDes_addr()];
-    auto chosen_send_path = avail_paths[intuniform(0, avail_paths.size()-1, par("rng").intValue())];
-    avail_paths = all_paths[req->getDes_addr()][req->getSrc_addr()];
-    auto chosen_back_path = avail_paths[intuniform(0, avail_paths.size()-1, par("rng").intValue())];
-    for(std::string s:chosen_send_path){
-        std::string cur_p = req->getSendPath();
-        req->setSendPath((cur_p + s + ",").c_str());
-    }
-    for(std::string s:chosen_back_path){
-        std::string cur_p = req->getBackPath();
-        req->setBackPath((cur_p + s + ",").c_str());
-    }
+    uint32_t des_id = system_topology.getId(des);
+    req->setDes_addr(des_id);
+    uint32_t num_paths = system_routes.countPaths(src_id, des_id);
+    if(num_paths == 0)
+        throw cRuntimeError("No route between %s and %s!\n", getParentModule()->getFullName(), des.c_str());
+
+    // both directions share the stored paths, the way back is walked in reverse
+    req->setSend_route(chooseRoute(req, src_id, des_id, num_paths));
+    req->setBack_route(chooseRoute(req, des_id, src_id, num_paths));
+    req->setSend_hop(0);
+    req->setBack_hop(0);
+    req->setLoad_route(req->getWork_type() == 'w' ? req->getSend_route() : req->getBack_route());
+    pinRoutes(req); // until the sinks release it
+    system_routes.addLoad(req->getLoad_route(), req->getData_size()); // released by the sinks
+
+    if(flow_engine && !flow_engine->isPacketLevel(req))
+        flow_engine->startFlow(req);
+    else
+        send(req, "port$o");
+}
 
-    send(req, "port$o");
+uint32_t WorkGenerator::chooseRoute(Request* req, uint32_t src, uint32_t des, uint32_t num_paths) {
+    uint32_t index = choosePath(this, path_policy, num_paths, flowHash(req, src), par("rng").intValue(),
+            [&](uint32_t i){ return system_routes.getRouteLoad(src, des, i); });
+    return system_routes.internRoute(src, des, index);
 }
 
 unsigned int WorkGenerator::fetchID() {
@@ -88,11 +101,11 @@ void WorkGenerator::handleMessage(cMessage *msg)
     if(msg->isSelfMessage()){
         initMsg(req);
         simtime_t delay = par("sendInterval").doubleValue();
-        Request* req = new Request();
+        Request* req = request_pool.acquire();
         id++;
         scheduleAt(simTime()+delay, req);
     }else{
-        cRuntimeError("Messages come into workload generator!\n");
+        throw cRuntimeError("Messages come into workload generator!\n");
     }
 }
 
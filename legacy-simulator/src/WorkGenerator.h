@@ -18,6 +18,7 @@
 
 #include <omnetpp.h>
 #include "General.h"
+#include "FlowEngine.h"
 
 using namespace omnetpp;
 
@@ -32,7 +33,10 @@ class WorkGenerator : public cSimpleModule
     unsigned int fetchID();
   private:
     unsigned int id;
+    FlowEngine* flow_engine; // set when the network runs at flow level, possibly with a packet-level region
+    PathPolicy path_policy;
     void initMsg(Request*);
+    uint32_t chooseRoute(Request*, uint32_t, uint32_t, uint32_t);
   protected:
     virtual void initialize() override;
     virtual void handleMessage(cMessage *msg) override;
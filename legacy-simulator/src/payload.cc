@@ -21,26 +21,25 @@ Define_Module(Payload);
 
 void Payload::initialize()
 {
-    for(int i=0; i<gateSize("port$o"); i++){
-        cGate* g = gate("port$o", i);
-        std::string neighbor_name = g->getNextGate()->getOwnerModule()->getFullName();
-        gate_to_neighbor[neighbor_name].first = "port$o";
-        gate_to_neighbor[neighbor_name].second = i;
-    }
+    for(int i=0; i<gateSize("port$o"); i++)
+        addNeighbor(gate("port$o", i), "port$o", i);
 
-    for(int i=0; i<gateSize("out"); i++){
-        cGate* g = gate("out", i);
-        std::string neighbor_name = g->getNextGate()->getOwnerModule()->getFullName();
-        gate_to_neighbor[neighbor_name].first = "out";
-        gate_to_neighbor[neighbor_name].second = i;
-    }
+    for(int i=0; i<gateSize("out"); i++)
+        addNeighbor(gate("out", i), "out", i);
 
+    parent_id = Topology::NO_NODE;
+    train_mode = par("train_mode").boolValue();
+    path_policy = parsePathPolicy(par("path_policy").stringValue());
+    frags_received = 0;
+    frags_reordered = 0;
 }
 
 void Payload::handleMessage(cMessage *msg)
 {
     Request* req = check_and_cast<Request*>(msg);
     std::string from_module_name = req->getSenderModule()->getName();
+    if(parent_id == Topology::NO_NODE) // system_topology is rebuilt by sink[0] during initialization
+        parent_id = system_topology.intern(getParentModule()->getFullName());
 
     if(strcmp(getName(), "payloadOST") == 0){
         if(req->getFinished())
@@ -80,7 +79,7 @@ void Payload::handleMessage(cMessage *msg)
                 else if(req->getWork_type() == 'w')
                     collectFromOSTs(req);
                 else
-                    cRuntimeError("Wrong work type!\n");
+                    throw cRuntimeError("Wrong work type!\n");
             }else{
                 toModuleName(req, "oss_in_payload");
             }
@@ -106,7 +105,7 @@ void Payload::handleMessage(cMessage *msg)
             toModuleName(req, "link_input");
 
         if(strcmp(getParentModule()->getName(), "pci") && strcmp(getParentModule()->getName(), "sas")){ // if not pci or sas cable
-            if(strlen(req->getSendPath()) > 1)
+            if(hasPath(req, 's'))
                 popPath(req, 's');
             else if(req->getFinished())
                 popPath(req, 'b');
@@ -148,7 +147,7 @@ void Payload::handleMessage(cMessage *msg)
 //                cRuntimeError("Please specify routing rules at %s\n", getName());
 //            }
 //        }else if(std::regex_match(req->getDes_addr(), std::regex("cn\\[[0-9]+\\]"))){
-            if(strcmp(req->getDes_addr(), getParentModule()->getFullName())) { // if start from original CN
+            if(req->getDes_addr() != parent_id) { // if start from original CN
                 if(!req->getFinished()) { //send message out
                     if(strcmp(req->getSenderModule()->getParentModule()->getName(), "pci") == 0){
                         toModuleName(req, "hca");
@@ -187,16 +186,16 @@ void Payload::handleMessage(cMessage *msg)
     }
 
     else if(strcmp(getName(), "edge_connect") == 0){
-        if(strlen(req->getSendPath()) > 1){
+        if(hasPath(req, 's')){
             if(strcmp(from_module_name.c_str(), "edge") == 0){
                 if(req->getWork_type() == 'w'){ // write request return to sink[1], without returnning to CN
                     work_arrive_status[req->getSrc_addr()][req->getMaster_id()][req->getId()] = 0;
                 }
             }
-            toModuleName(req, popPath(req, 's'));
-        }else if(strlen(req->getBackPath()) > 1){
+            toModuleName(req, system_topology.getName(popPath(req, 's')));
+        }else if(hasPath(req, 'b')){
             if(req->getWork_type() == 'r'){
-                toModuleName(req, popPath(req, 'b'));
+                toModuleName(req, system_topology.getName(popPath(req, 'b')));
             }else if(req->getWork_type() == 'w')
                 collectFromOSTs(req);
         }else{
@@ -205,38 +204,88 @@ void Payload::handleMessage(cMessage *msg)
     }
 }
 
+void Payload::finish() {
+    if(frags_received){
+        recordScalar("fragmentsCollected", frags_received);
+        recordScalar("fragmentsReordered", frags_reordered);
+        recordScalar("reorderRate", (double)frags_reordered / frags_received);
+    }
+}
+
 int Payload::getGateToExit() {
     int gsize = gateSize("out");
     return intuniform(0, gsize-1, par("rng").intValue());
 }
 
+void Payload::addNeighbor(cGate* g, const char* gate_name, int index) {
+    cModule* neighbor = g->getNextGate()->getOwnerModule();
+    std::string neighbor_name = neighbor->getFullName();
+    if(!gate_to_neighbor.count(neighbor_name) && neighbor->isVector())
+        vector_neighbors[neighbor->getName()].push_back(neighbor_name);
+    gate_to_neighbor[neighbor_name].first = gate_name;
+    gate_to_neighbor[neighbor_name].second = index;
+}
+
 void Payload::toModuleName(Request* req, const std::string m_name) {
-    cGate* g;
     if(gate_to_neighbor.count(m_name)) {
-        g = gate(gate_to_neighbor[m_name].first.c_str(), gate_to_neighbor[m_name].second);
-        sendDelayed(req, transTimestampByCable(g)-simTime(), gate_to_neighbor[m_name].first.c_str(), gate_to_neighbor[m_name].second);
+        sendToNeighbor(req, m_name);
     }else{
-        std::vector<std::string> m_name_vec;
-        for(auto ele:gate_to_neighbor){
-            if(std::regex_match(ele.first, std::regex(m_name+"\\[[0-9]+\\]"))){
-                m_name_vec.push_back(ele.first);
-            }
+        auto it = vector_neighbors.find(m_name);
+        if(it == vector_neighbors.end())
+            throw cRuntimeError("No neighbor %s at %s!\n", m_name.c_str(), getFullPath().c_str());
+        const std::vector<std::string>& m_name_vec = it->second;
+
+        if(req->getFrag_count() > 1 && m_name_vec.size() > 1 && path_policy != POLICY_FLOW_HASH){ // fragments of a train pick their lanes independently
+            std::vector<uint32_t> counts(m_name_vec.size(), 0);
+            for(uint32_t i=0; i<req->getFrag_count(); i++)
+                counts[intuniform(0, m_name_vec.size()-1, par("rng").intValue())]++;
+            splitTrain(req, m_name_vec, counts);
+        }else{
+            // lanes have no occupancy counters, the load-aware policies see them all idle
+            uint32_t lane = choosePath(this, path_policy, m_name_vec.size(), flowHash(req, parent_id), par("rng").intValue(), [](uint32_t){ return (uint64_t)0; });
+            sendToNeighbor(req, m_name_vec[lane]);
         }
+    }
+}
 
-        std::string chosen_m_name = m_name_vec[intuniform(0, m_name_vec.size()-1, par("rng").intValue())];
-        g = gate(gate_to_neighbor[chosen_m_name].first.c_str(), gate_to_neighbor[chosen_m_name].second);
-        sendDelayed(req, transTimestampByCable(g)-simTime(), gate_to_neighbor[chosen_m_name].first.c_str(), gate_to_neighbor[chosen_m_name].second);
+void Payload::sendToNeighbor(Request* req, const std::string& m_name) {
+    auto& neighbor = gate_to_neighbor[m_name];
+    cGate* g = gate(neighbor.first.c_str(), neighbor.second);
+    sendDelayed(req, transTimestampByCable(g)-simTime(), neighbor.first.c_str(), neighbor.second);
+}
+
+void Payload::splitTrain(Request* req, const std::vector<std::string>& m_names, const std::vector<uint32_t>& counts) {
+    // one sub-train per neighbor that got fragments; the original request carries the last one
+    int64_t frag_bytes = req->getByteLength() / req->getFrag_count();
+    size_t last = counts.size();
+    while(last > 0 && counts[last-1] == 0)
+        last--;
+
+    uint64_t offset = req->getFrag_offset();
+    for(size_t i=0; i<last; i++){
+        if(counts[i] == 0)
+            continue;
+        Request* part = i+1 < last ? request_pool.dup(req) : req;
+        part->setFrag_count(counts[i]);
+        part->setFrag_offset(offset);
+        part->setByteLength(frag_bytes * counts[i]);
+        offset += frag_bytes * counts[i];
+        sendToNeighbor(part, m_names[i]);
     }
 }
 
 void Payload::collectFromOSTs(Request* req) {
     // toModuleName(req, "oss_memory");
+    trackOrder(req);
     if(req->getWork_type() == 'r'){
-        work_arrive_status[req->getSrc_addr()][req->getMaster_id()][req->getId()] += req->getFrag_size();
+        work_arrive_status[req->getSrc_addr()][req->getMaster_id()][req->getId()] += (int64_t)req->getFrag_size() * req->getFrag_count();
         if(work_arrive_status[req->getSrc_addr()][req->getMaster_id()][req->getId()] == req->getData_size()){
+            frag_high.erase(fragKey(req));
+            req->setFrag_offset(0);
             if(strcmp(getParentModule()->getName(), "oss") == 0)
                 req->setByteLength(req->getData_size());
             req->setFrag_size(req->getData_size());
+            req->setFrag_count(1);
 
             if(strcmp(getParentModule()->getName(), "oss") == 0){
                 toModuleName(req, "oss_memory");
@@ -253,15 +302,18 @@ void Payload::collectFromOSTs(Request* req) {
                     work_arrive_status[req->getSrc_addr()].erase(req->getMaster_id());
                 }
             }else{
-                cRuntimeError("wrong!!!!!!!!!!!!!");
+                throw cRuntimeError("%s collects fragments outside a CN or OSS!\n", getFullPath().c_str());
             }
         }else{
-            delete(req);
+            request_pool.release(req);
         }
     }else if(req->getWork_type() == 'w'){
-        work_arrive_status[req->getSrc_addr()][req->getMaster_id()][req->getId()] += req->getFrag_size();
+        work_arrive_status[req->getSrc_addr()][req->getMaster_id()][req->getId()] += (int64_t)req->getFrag_size() * req->getFrag_count();
         if(work_arrive_status[req->getSrc_addr()][req->getMaster_id()][req->getId()] == req->getData_size()){
+            frag_high.erase(fragKey(req));
+            req->setFrag_offset(0);
             req->setFrag_size(req->getData_size());
+            req->setFrag_count(1);
 
             if(strcmp(getParentModule()->getName(), "oss") == 0){
                 if(strcmp(getName(), "oss_hub_mem_hca") == 0){
@@ -295,7 +347,7 @@ void Payload::collectFromOSTs(Request* req) {
             }
 
         }else{
-            delete(req);
+            request_pool.release(req);
         }
     }
 }
@@ -315,15 +367,58 @@ const bool Payload::checkAllIdArrival(Request* req) {
     return ans;
 }
 
+uint64_t Payload::fragKey(Request* req) {
+    uint32_t key[3] = {req->getSrc_addr(), req->getMaster_id(), req->getId()};
+    return fnv1a(key, sizeof(key));
+}
+
+void Payload::trackOrder(Request* req) {
+    // a fragment is reordered if data behind it has already been collected
+    uint64_t& high = frag_high[fragKey(req)];
+    if(req->getFrag_offset() < high)
+        frags_reordered += req->getFrag_count();
+    high = std::max(high, req->getFrag_offset() + (uint64_t)req->getFrag_size() * req->getFrag_count());
+    frags_received += req->getFrag_count();
+}
+
 void Payload::sendOstByStripe(Request* req) {
-    short ost_ind = (req->getTarget_ost() + intuniform(0, STRIPE_COUNT-1, par("rng").intValue())) % getParentModule()->getSubmoduleVectorSize("ost");
+    int num_ost = getParentModule()->getSubmoduleVectorSize("ost");
+    if(req->getFrag_count() > 1){ // stripes of a train are spread over the OSTs one by one
+        std::vector<std::string> sas_names;
+        std::vector<uint32_t> counts(STRIPE_COUNT, 0);
+        for(int i=0; i<STRIPE_COUNT; i++)
+            sas_names.push_back("sas["+std::to_string((req->getTarget_ost() + i) % num_ost)+"]");
+        for(uint32_t i=0; i<req->getFrag_count(); i++)
+            counts[intuniform(0, STRIPE_COUNT-1, par("rng").intValue())]++;
+        splitTrain(req, sas_names, counts);
+        return;
+    }
+
+    short ost_ind = (req->getTarget_ost() + intuniform(0, STRIPE_COUNT-1, par("rng").intValue())) % num_ost;
     toModuleName(req, ("sas["+std::to_string(ost_ind)+"]").c_str());
 }
 
 void Payload::segAndSend(Request* req, int64_t total_size, const int seg_size, const char* dest) {
-    if(total_size > seg_size){
+    if(total_size > seg_size && train_mode){ // full segments travel as one train, the remainder on its own
+        int64_t num_full = total_size / seg_size, rest = total_size % seg_size;
+        if(rest){
+            auto tail_req = request_pool.dup(req);
+            tail_req->setFrag_count(1);
+            tail_req->setFrag_offset(req->getFrag_offset() + num_full * seg_size);
+            tail_req->setFrag_size(rest);
+            tail_req->setByteLength(rest);
+            toModuleName(tail_req, dest);
+        }
+        req->setFrag_count(num_full);
+        req->setFrag_size(seg_size);
+        req->setByteLength(num_full * seg_size);
+        toModuleName(req, dest);
+    }else if(total_size > seg_size){
+        uint64_t offset = req->getFrag_offset();
         while(total_size > 0) {
-            auto new_req = req->dup();
+            auto new_req = request_pool.dup(req);
+            new_req->setFrag_count(1);
+            new_req->setFrag_offset(offset);
             if(total_size <= seg_size){
                 new_req->setFrag_size(total_size);
                 new_req->setByteLength(total_size);
@@ -333,8 +428,9 @@ void Payload::segAndSend(Request* req, int64_t total_size, const int seg_size, c
             }
             toModuleName(new_req, dest);
             total_size -= seg_size;
+            offset += seg_size;
         }
-        delete req;
+        request_pool.release(req);
     }else{
         toModuleName(req, dest);
     }
@@ -31,10 +31,21 @@ class Payload : public cSimpleModule
   protected:
     virtual void initialize() override;
     virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;
   private:
     std::unordered_map<std::string, std::pair<std::string, int>> gate_to_neighbor;
-    std::unordered_map<std::string, std::unordered_map<unsigned int, std::unordered_map<unsigned int, int64_t>>> work_arrive_status;
+    std::unordered_map<std::string, std::vector<std::string>> vector_neighbors; // "link_input" -> "link_input[0]", ...
+    std::unordered_map<uint32_t, std::unordered_map<unsigned int, std::unordered_map<unsigned int, int64_t>>> work_arrive_status; // keyed by source node ID
+    uint32_t parent_id;
+    bool train_mode;
+    PathPolicy path_policy;
+    std::unordered_map<uint64_t, uint64_t> frag_high; // per (src, master_id, id): end of the furthest fragment collected
+    uint64_t frags_received;
+    uint64_t frags_reordered;
+    void addNeighbor(cGate*, const char*, int);
     void toModuleName(Request*, const std::string);
+    void sendToNeighbor(Request*, const std::string&);
+    void splitTrain(Request*, const std::vector<std::string>&, const std::vector<uint32_t>&);
 //    std::string popPath(Request*, char);
 
     // payload in OST network
@@ -42,6 +53,8 @@ class Payload : public cSimpleModule
 
     // in OSS, CN, to assemble data read from(or written to) OSTs
     void collectFromOSTs(Request*);
+    static uint64_t fragKey(Request*);
+    void trackOrder(Request*);
     const bool checkAllIdArrival(Request*); // check if all child processes arrive at the original CN
     void sendOstByStripe(Request*);
 
@@ -186,14 +186,19 @@ void Request::copy(const Request& other)
     this->master_id = other.master_id;
     this->num_proc = other.num_proc;
     this->frag_size = other.frag_size;
+    this->frag_count = other.frag_count;
+    this->frag_offset = other.frag_offset;
     this->data_size = other.data_size;
     this->proc_time = other.proc_time;
     this->src_addr = other.src_addr;
     this->des_addr = other.des_addr;
     this->master_id_addr = other.master_id_addr;
     this->next_hop_addr = other.next_hop_addr;
-    this->sendPath = other.sendPath;
-    this->backPath = other.backPath;
+    this->send_route = other.send_route;
+    this->back_route = other.back_route;
+    this->load_route = other.load_route;
+    this->send_hop = other.send_hop;
+    this->back_hop = other.back_hop;
     this->generate_time = other.generate_time;
     this->arriveModule_time = other.arriveModule_time;
     this->leaveModule_time = other.leaveModule_time;
@@ -211,14 +216,19 @@ void Request::parsimPack(omnetpp::cCommBuffer *b) const
     doParsimPacking(b,this->master_id);
     doParsimPacking(b,this->num_proc);
     doParsimPacking(b,this->frag_size);
+    doParsimPacking(b,this->frag_count);
+    doParsimPacking(b,this->frag_offset);
     doParsimPacking(b,this->data_size);
     doParsimPacking(b,this->proc_time);
     doParsimPacking(b,this->src_addr);
     doParsimPacking(b,this->des_addr);
     doParsimPacking(b,this->master_id_addr);
     doParsimPacking(b,this->next_hop_addr);
-    doParsimPacking(b,this->sendPath);
-    doParsimPacking(b,this->backPath);
+    doParsimPacking(b,this->send_route);
+    doParsimPacking(b,this->back_route);
+    doParsimPacking(b,this->load_route);
+    doParsimPacking(b,this->send_hop);
+    doParsimPacking(b,this->back_hop);
     doParsimPacking(b,this->generate_time);
     doParsimPacking(b,this->arriveModule_time);
     doParsimPacking(b,this->leaveModule_time);
@@ -236,14 +246,19 @@ void Request::parsimUnpack(omnetpp::cCommBuffer *b)
     doParsimUnpacking(b,this->master_id);
     doParsimUnpacking(b,this->num_proc);
     doParsimUnpacking(b,this->frag_size);
+    doParsimUnpacking(b,this->frag_count);
+    doParsimUnpacking(b,this->frag_offset);
     doParsimUnpacking(b,this->data_size);
     doParsimUnpacking(b,this->proc_time);
     doParsimUnpacking(b,this->src_addr);
     doParsimUnpacking(b,this->des_addr);
     doParsimUnpacking(b,this->master_id_addr);
     doParsimUnpacking(b,this->next_hop_addr);
-    doParsimUnpacking(b,this->sendPath);
-    doParsimUnpacking(b,this->backPath);
+    doParsimUnpacking(b,this->send_route);
+    doParsimUnpacking(b,this->back_route);
+    doParsimUnpacking(b,this->load_route);
+    doParsimUnpacking(b,this->send_hop);
+    doParsimUnpacking(b,this->back_hop);
     doParsimUnpacking(b,this->generate_time);
     doParsimUnpacking(b,this->arriveModule_time);
     doParsimUnpacking(b,this->leaveModule_time);
@@ -339,6 +354,26 @@ void Request::setFrag_size(uint32_t frag_size)
     this->frag_size = frag_size;
 }
 
+uint32_t Request::getFrag_count() const
+{
+    return this->frag_count;
+}
+
+void Request::setFrag_count(uint32_t frag_count)
+{
+    this->frag_count = frag_count;
+}
+
+uint64_t Request::getFrag_offset() const
+{
+    return this->frag_offset;
+}
+
+void Request::setFrag_offset(uint64_t frag_offset)
+{
+    this->frag_offset = frag_offset;
+}
+
 uint64_t Request::getData_size() const
 {
     return this->data_size;
@@ -359,64 +394,94 @@ void Request::setProc_time(double proc_time)
     this->proc_time = proc_time;
 }
 
-const char * Request::getSrc_addr() const
+uint32_t Request::getSrc_addr() const
 {
-    return this->src_addr.c_str();
+    return this->src_addr;
 }
 
-void Request::setSrc_addr(const char * src_addr)
+void Request::setSrc_addr(uint32_t src_addr)
 {
     this->src_addr = src_addr;
 }
 
-const char * Request::getDes_addr() const
+uint32_t Request::getDes_addr() const
 {
-    return this->des_addr.c_str();
+    return this->des_addr;
 }
 
-void Request::setDes_addr(const char * des_addr)
+void Request::setDes_addr(uint32_t des_addr)
 {
     this->des_addr = des_addr;
 }
 
-const char * Request::getMaster_id_addr() const
+uint32_t Request::getMaster_id_addr() const
 {
-    return this->master_id_addr.c_str();
+    return this->master_id_addr;
 }
 
-void Request::setMaster_id_addr(const char * master_id_addr)
+void Request::setMaster_id_addr(uint32_t master_id_addr)
 {
     this->master_id_addr = master_id_addr;
 }
 
-const char * Request::getNext_hop_addr() const
+uint32_t Request::getNext_hop_addr() const
 {
-    return this->next_hop_addr.c_str();
+    return this->next_hop_addr;
 }
 
-void Request::setNext_hop_addr(const char * next_hop_addr)
+void Request::setNext_hop_addr(uint32_t next_hop_addr)
 {
     this->next_hop_addr = next_hop_addr;
 }
 
-const char * Request::getSendPath() const
+uint32_t Request::getSend_route() const
+{
+    return this->send_route;
+}
+
+void Request::setSend_route(uint32_t send_route)
+{
+    this->send_route = send_route;
+}
+
+uint32_t Request::getBack_route() const
+{
+    return this->back_route;
+}
+
+void Request::setBack_route(uint32_t back_route)
+{
+    this->back_route = back_route;
+}
+
+uint32_t Request::getLoad_route() const
+{
+    return this->load_route;
+}
+
+void Request::setLoad_route(uint32_t load_route)
+{
+    this->load_route = load_route;
+}
+
+uint16_t Request::getSend_hop() const
 {
-    return this->sendPath.c_str();
+    return this->send_hop;
 }
 
-void Request::setSendPath(const char * sendPath)
+void Request::setSend_hop(uint16_t send_hop)
 {
-    this->sendPath = sendPath;
+    this->send_hop = send_hop;
 }
 
-const char * Request::getBackPath() const
+uint16_t Request::getBack_hop() const
 {
-    return this->backPath.c_str();
+    return this->back_hop;
 }
 
-void Request::setBackPath(const char * backPath)
+void Request::setBack_hop(uint16_t back_hop)
 {
-    this->backPath = backPath;
+    this->back_hop = back_hop;
 }
 
 ::omnetpp::simtime_t Request::getGenerate_time() const
@@ -463,14 +528,19 @@ class RequestDescriptor : public omnetpp::cClassDescriptor
         FIELD_master_id,
         FIELD_num_proc,
         FIELD_frag_size,
+        FIELD_frag_count,
+        FIELD_frag_offset,
         FIELD_data_size,
         FIELD_proc_time,
         FIELD_src_addr,
         FIELD_des_addr,
         FIELD_master_id_addr,
         FIELD_next_hop_addr,
-        FIELD_sendPath,
-        FIELD_backPath,
+        FIELD_send_route,
+        FIELD_back_route,
+        FIELD_load_route,
+        FIELD_send_hop,
+        FIELD_back_hop,
         FIELD_generate_time,
         FIELD_arriveModule_time,
         FIELD_leaveModule_time,
@@ -540,7 +610,7 @@ const char *RequestDescriptor::getProperty(const char *propertyName) const
 int RequestDescriptor::getFieldCount() const
 {
     omnetpp::cClassDescriptor *base = getBaseClassDescriptor();
-    return base ? 20+base->getFieldCount() : 20;
+    return base ? 25+base->getFieldCount() : 25;
 }
 
 unsigned int RequestDescriptor::getFieldTypeFlags(int field) const
@@ -561,19 +631,24 @@ unsigned int RequestDescriptor::getFieldTypeFlags(int field) const
         FD_ISEDITABLE,    // FIELD_master_id
         FD_ISEDITABLE,    // FIELD_num_proc
         FD_ISEDITABLE,    // FIELD_frag_size
+        FD_ISEDITABLE,    // FIELD_frag_count
+        FD_ISEDITABLE,    // FIELD_frag_offset
         FD_ISEDITABLE,    // FIELD_data_size
         FD_ISEDITABLE,    // FIELD_proc_time
         FD_ISEDITABLE,    // FIELD_src_addr
         FD_ISEDITABLE,    // FIELD_des_addr
         FD_ISEDITABLE,    // FIELD_master_id_addr
         FD_ISEDITABLE,    // FIELD_next_hop_addr
-        FD_ISEDITABLE,    // FIELD_sendPath
-        FD_ISEDITABLE,    // FIELD_backPath
+        FD_ISEDITABLE,    // FIELD_send_route
+        FD_ISEDITABLE,    // FIELD_back_route
+        FD_ISEDITABLE,    // FIELD_load_route
+        FD_ISEDITABLE,    // FIELD_send_hop
+        FD_ISEDITABLE,    // FIELD_back_hop
         FD_ISEDITABLE,    // FIELD_generate_time
         FD_ISEDITABLE,    // FIELD_arriveModule_time
         FD_ISEDITABLE,    // FIELD_leaveModule_time
     };
-    return (field >= 0 && field < 20) ? fieldTypeFlags[field] : 0;
+    return (field >= 0 && field < 25) ? fieldTypeFlags[field] : 0;
 }
 
 const char *RequestDescriptor::getFieldName(int field) const
@@ -594,19 +669,24 @@ const char *RequestDescriptor::getFieldName(int field) const
         "master_id",
         "num_proc",
         "frag_size",
+        "frag_count",
+        "frag_offset",
         "data_size",
         "proc_time",
         "src_addr",
         "des_addr",
         "master_id_addr",
         "next_hop_addr",
-        "sendPath",
-        "backPath",
+        "send_route",
+        "back_route",
+        "load_route",
+        "send_hop",
+        "back_hop",
         "generate_time",
         "arriveModule_time",
         "leaveModule_time",
     };
-    return (field >= 0 && field < 20) ? fieldNames[field] : nullptr;
+    return (field >= 0 && field < 25) ? fieldNames[field] : nullptr;
 }
 
 int RequestDescriptor::findField(const char *fieldName) const
@@ -622,17 +702,22 @@ int RequestDescriptor::findField(const char *fieldName) const
     if (strcmp(fieldName, "master_id") == 0) return baseIndex + 6;
     if (strcmp(fieldName, "num_proc") == 0) return baseIndex + 7;
     if (strcmp(fieldName, "frag_size") == 0) return baseIndex + 8;
-    if (strcmp(fieldName, "data_size") == 0) return baseIndex + 9;
-    if (strcmp(fieldName, "proc_time") == 0) return baseIndex + 10;
-    if (strcmp(fieldName, "src_addr") == 0) return baseIndex + 11;
-    if (strcmp(fieldName, "des_addr") == 0) return baseIndex + 12;
-    if (strcmp(fieldName, "master_id_addr") == 0) return baseIndex + 13;
-    if (strcmp(fieldName, "next_hop_addr") == 0) return baseIndex + 14;
-    if (strcmp(fieldName, "sendPath") == 0) return baseIndex + 15;
-    if (strcmp(fieldName, "backPath") == 0) return baseIndex + 16;
-    if (strcmp(fieldName, "generate_time") == 0) return baseIndex + 17;
-    if (strcmp(fieldName, "arriveModule_time") == 0) return baseIndex + 18;
-    if (strcmp(fieldName, "leaveModule_time") == 0) return baseIndex + 19;
+    if (strcmp(fieldName, "frag_count") == 0) return baseIndex + 9;
+    if (strcmp(fieldName, "frag_offset") == 0) return baseIndex + 10;
+    if (strcmp(fieldName, "data_size") == 0) return baseIndex + 11;
+    if (strcmp(fieldName, "proc_time") == 0) return baseIndex + 12;
+    if (strcmp(fieldName, "src_addr") == 0) return baseIndex + 13;
+    if (strcmp(fieldName, "des_addr") == 0) return baseIndex + 14;
+    if (strcmp(fieldName, "master_id_addr") == 0) return baseIndex + 15;
+    if (strcmp(fieldName, "next_hop_addr") == 0) return baseIndex + 16;
+    if (strcmp(fieldName, "send_route") == 0) return baseIndex + 17;
+    if (strcmp(fieldName, "back_route") == 0) return baseIndex + 18;
+    if (strcmp(fieldName, "load_route") == 0) return baseIndex + 19;
+    if (strcmp(fieldName, "send_hop") == 0) return baseIndex + 20;
+    if (strcmp(fieldName, "back_hop") == 0) return baseIndex + 21;
+    if (strcmp(fieldName, "generate_time") == 0) return baseIndex + 22;
+    if (strcmp(fieldName, "arriveModule_time") == 0) return baseIndex + 23;
+    if (strcmp(fieldName, "leaveModule_time") == 0) return baseIndex + 24;
     return base ? base->findField(fieldName) : -1;
 }
 
@@ -654,19 +739,24 @@ const char *RequestDescriptor::getFieldTypeString(int field) const
         "uint32_t",    // FIELD_master_id
         "uint32_t",    // FIELD_num_proc
         "uint32_t",    // FIELD_frag_size
+        "uint32_t",    // FIELD_frag_count
+        "uint64_t",    // FIELD_frag_offset
         "uint64_t",    // FIELD_data_size
         "double",    // FIELD_proc_time
-        "string",    // FIELD_src_addr
-        "string",    // FIELD_des_addr
-        "string",    // FIELD_master_id_addr
-        "string",    // FIELD_next_hop_addr
-        "string",    // FIELD_sendPath
-        "string",    // FIELD_backPath
+        "uint32_t",    // FIELD_src_addr
+        "uint32_t",    // FIELD_des_addr
+        "uint32_t",    // FIELD_master_id_addr
+        "uint32_t",    // FIELD_next_hop_addr
+        "uint32_t",    // FIELD_send_route
+        "uint32_t",    // FIELD_back_route
+        "uint32_t",    // FIELD_load_route
+        "uint16_t",    // FIELD_send_hop
+        "uint16_t",    // FIELD_back_hop
         "omnetpp::simtime_t",    // FIELD_generate_time
         "omnetpp::simtime_t",    // FIELD_arriveModule_time
         "omnetpp::simtime_t",    // FIELD_leaveModule_time
     };
-    return (field >= 0 && field < 20) ? fieldTypeStrings[field] : nullptr;
+    return (field >= 0 && field < 25) ? fieldTypeStrings[field] : nullptr;
 }
 
 const char **RequestDescriptor::getFieldPropertyNames(int field) const
@@ -758,14 +848,19 @@ std::string RequestDescriptor::getFieldValueAsString(omnetpp::any_ptr object, in
         case FIELD_master_id: return ulong2string(pp->getMaster_id());
         case FIELD_num_proc: return ulong2string(pp->getNum_proc());
         case FIELD_frag_size: return ulong2string(pp->getFrag_size());
+        case FIELD_frag_count: return ulong2string(pp->getFrag_count());
+        case FIELD_frag_offset: return uint642string(pp->getFrag_offset());
         case FIELD_data_size: return uint642string(pp->getData_size());
         case FIELD_proc_time: return double2string(pp->getProc_time());
-        case FIELD_src_addr: return oppstring2string(pp->getSrc_addr());
-        case FIELD_des_addr: return oppstring2string(pp->getDes_addr());
-        case FIELD_master_id_addr: return oppstring2string(pp->getMaster_id_addr());
-        case FIELD_next_hop_addr: return oppstring2string(pp->getNext_hop_addr());
-        case FIELD_sendPath: return oppstring2string(pp->getSendPath());
-        case FIELD_backPath: return oppstring2string(pp->getBackPath());
+        case FIELD_src_addr: return ulong2string(pp->getSrc_addr());
+        case FIELD_des_addr: return ulong2string(pp->getDes_addr());
+        case FIELD_master_id_addr: return ulong2string(pp->getMaster_id_addr());
+        case FIELD_next_hop_addr: return ulong2string(pp->getNext_hop_addr());
+        case FIELD_send_route: return ulong2string(pp->getSend_route());
+        case FIELD_back_route: return ulong2string(pp->getBack_route());
+        case FIELD_load_route: return ulong2string(pp->getLoad_route());
+        case FIELD_send_hop: return ulong2string(pp->getSend_hop());
+        case FIELD_back_hop: return ulong2string(pp->getBack_hop());
         case FIELD_generate_time: return simtime2string(pp->getGenerate_time());
         case FIELD_arriveModule_time: return simtime2string(pp->getArriveModule_time());
         case FIELD_leaveModule_time: return simtime2string(pp->getLeaveModule_time());
@@ -794,14 +889,19 @@ void RequestDescriptor::setFieldValueAsString(omnetpp::any_ptr object, int field
         case FIELD_master_id: pp->setMaster_id(string2ulong(value)); break;
         case FIELD_num_proc: pp->setNum_proc(string2ulong(value)); break;
         case FIELD_frag_size: pp->setFrag_size(string2ulong(value)); break;
+        case FIELD_frag_count: pp->setFrag_count(string2ulong(value)); break;
+        case FIELD_frag_offset: pp->setFrag_offset(string2uint64(value)); break;
         case FIELD_data_size: pp->setData_size(string2uint64(value)); break;
         case FIELD_proc_time: pp->setProc_time(string2double(value)); break;
-        case FIELD_src_addr: pp->setSrc_addr((value)); break;
-        case FIELD_des_addr: pp->setDes_addr((value)); break;
-        case FIELD_master_id_addr: pp->setMaster_id_addr((value)); break;
-        case FIELD_next_hop_addr: pp->setNext_hop_addr((value)); break;
-        case FIELD_sendPath: pp->setSendPath((value)); break;
-        case FIELD_backPath: pp->setBackPath((value)); break;
+        case FIELD_src_addr: pp->setSrc_addr(string2ulong(value)); break;
+        case FIELD_des_addr: pp->setDes_addr(string2ulong(value)); break;
+        case FIELD_master_id_addr: pp->setMaster_id_addr(string2ulong(value)); break;
+        case FIELD_next_hop_addr: pp->setNext_hop_addr(string2ulong(value)); break;
+        case FIELD_send_route: pp->setSend_route(string2ulong(value)); break;
+        case FIELD_back_route: pp->setBack_route(string2ulong(value)); break;
+        case FIELD_load_route: pp->setLoad_route(string2ulong(value)); break;
+        case FIELD_send_hop: pp->setSend_hop(string2ulong(value)); break;
+        case FIELD_back_hop: pp->setBack_hop(string2ulong(value)); break;
         case FIELD_generate_time: pp->setGenerate_time(string2simtime(value)); break;
         case FIELD_arriveModule_time: pp->setArriveModule_time(string2simtime(value)); break;
         case FIELD_leaveModule_time: pp->setLeaveModule_time(string2simtime(value)); break;
@@ -828,14 +928,19 @@ omnetpp::cValue RequestDescriptor::getFieldValue(omnetpp::any_ptr object, int fi
         case FIELD_master_id: return (omnetpp::intval_t)(pp->getMaster_id());
         case FIELD_num_proc: return (omnetpp::intval_t)(pp->getNum_proc());
         case FIELD_frag_size: return (omnetpp::intval_t)(pp->getFrag_size());
+        case FIELD_frag_count: return (omnetpp::intval_t)(pp->getFrag_count());
+        case FIELD_frag_offset: return (omnetpp::intval_t)(pp->getFrag_offset());
         case FIELD_data_size: return (omnetpp::intval_t)(pp->getData_size());
         case FIELD_proc_time: return pp->getProc_time();
-        case FIELD_src_addr: return pp->getSrc_addr();
-        case FIELD_des_addr: return pp->getDes_addr();
-        case FIELD_master_id_addr: return pp->getMaster_id_addr();
-        case FIELD_next_hop_addr: return pp->getNext_hop_addr();
-        case FIELD_sendPath: return pp->getSendPath();
-        case FIELD_backPath: return pp->getBackPath();
+        case FIELD_src_addr: return (omnetpp::intval_t)(pp->getSrc_addr());
+        case FIELD_des_addr: return (omnetpp::intval_t)(pp->getDes_addr());
+        case FIELD_master_id_addr: return (omnetpp::intval_t)(pp->getMaster_id_addr());
+        case FIELD_next_hop_addr: return (omnetpp::intval_t)(pp->getNext_hop_addr());
+        case FIELD_send_route: return (omnetpp::intval_t)(pp->getSend_route());
+        case FIELD_back_route: return (omnetpp::intval_t)(pp->getBack_route());
+        case FIELD_load_route: return (omnetpp::intval_t)(pp->getLoad_route());
+        case FIELD_send_hop: return (omnetpp::intval_t)(pp->getSend_hop());
+        case FIELD_back_hop: return (omnetpp::intval_t)(pp->getBack_hop());
         case FIELD_generate_time: return pp->getGenerate_time().dbl();
         case FIELD_arriveModule_time: return pp->getArriveModule_time().dbl();
         case FIELD_leaveModule_time: return pp->getLeaveModule_time().dbl();
@@ -864,14 +969,19 @@ void RequestDescriptor::setFieldValue(omnetpp::any_ptr object, int field, int i,
         case FIELD_master_id: pp->setMaster_id(omnetpp::checked_int_cast<uint32_t>(value.intValue())); break;
         case FIELD_num_proc: pp->setNum_proc(omnetpp::checked_int_cast<uint32_t>(value.intValue())); break;
         case FIELD_frag_size: pp->setFrag_size(omnetpp::checked_int_cast<uint32_t>(value.intValue())); break;
+        case FIELD_frag_count: pp->setFrag_count(omnetpp::checked_int_cast<uint32_t>(value.intValue())); break;
+        case FIELD_frag_offset: pp->setFrag_offset(omnetpp::checked_int_cast<uint64_t>(value.intValue())); break;
         case FIELD_data_size: pp->setData_size(omnetpp::checked_int_cast<uint64_t>(value.intValue())); break;
         case FIELD_proc_time: pp->setProc_time(value.doubleValue()); break;
-        case FIELD_src_addr: pp->setSrc_addr(value.stringValue()); break;
-        case FIELD_des_addr: pp->setDes_addr(value.stringValue()); break;
-        case FIELD_master_id_addr: pp->setMaster_id_addr(value.stringValue()); break;
-        case FIELD_next_hop_addr: pp->setNext_hop_addr(value.stringValue()); break;
-        case FIELD_sendPath: pp->setSendPath(value.stringValue()); break;
-        case FIELD_backPath: pp->setBackPath(value.stringValue()); break;
+        case FIELD_src_addr: pp->setSrc_addr(omnetpp::checked_int_cast<uint32_t>(value.intValue())); break;
+        case FIELD_des_addr: pp->setDes_addr(omnetpp::checked_int_cast<uint32_t>(value.intValue())); break;
+        case FIELD_master_id_addr: pp->setMaster_id_addr(omnetpp::checked_int_cast<uint32_t>(value.intValue())); break;
+        case FIELD_next_hop_addr: pp->setNext_hop_addr(omnetpp::checked_int_cast<uint32_t>(value.intValue())); break;
+        case FIELD_send_route: pp->setSend_route(omnetpp::checked_int_cast<uint32_t>(value.intValue())); break;
+        case FIELD_back_route: pp->setBack_route(omnetpp::checked_int_cast<uint32_t>(value.intValue())); break;
+        case FIELD_load_route: pp->setLoad_route(omnetpp::checked_int_cast<uint32_t>(value.intValue())); break;
+        case FIELD_send_hop: pp->setSend_hop(omnetpp::checked_int_cast<uint16_t>(value.intValue())); break;
+        case FIELD_back_hop: pp->setBack_hop(omnetpp::checked_int_cast<uint16_t>(value.intValue())); break;
         case FIELD_generate_time: pp->setGenerate_time(value.doubleValue()); break;
         case FIELD_arriveModule_time: pp->setArriveModule_time(value.doubleValue()); break;
         case FIELD_leaveModule_time: pp->setLeaveModule_time(value.doubleValue()); break;
@@ -44,14 +44,19 @@ namespace fattreenew {
  *     uint32_t master_id;
  *     uint32_t num_proc;
  *     uint32_t frag_size;
+ *     uint32_t frag_count = 1;          // > 1 for a train of equal fragments of frag_size bytes each
+ *     uint64_t frag_offset;             // of the first byte within data_size, to measure reordering
  *     uint64_t data_size;
  *     double proc_time;
- *     string src_addr;
- *     string des_addr;
- *     string master_id_addr;
- *     string next_hop_addr;
- *     string sendPath;
- *     string backPath;
+ *     uint32_t src_addr = UINT32_MAX;       // node IDs interned in system_topology
+ *     uint32_t des_addr = UINT32_MAX;
+ *     uint32_t master_id_addr = UINT32_MAX;
+ *     uint32_t next_hop_addr = UINT32_MAX;
+ *     uint32_t send_route = UINT32_MAX; // route IDs interned in system_routes
+ *     uint32_t back_route = UINT32_MAX;
+ *     uint32_t load_route = UINT32_MAX; // data route charged at the source and released by the sinks
+ *     uint16_t send_hop;                // cursor of the next hop on each route
+ *     uint16_t back_hop;
  *     simtime_t generate_time;
  *     simtime_t arriveModule_time;
  *     simtime_t leaveModule_time;
@@ -71,14 +76,19 @@ class Request : public ::omnetpp::cPacket
     uint32_t master_id = 0;
     uint32_t num_proc = 0;
     uint32_t frag_size = 0;
+    uint32_t frag_count = 1;
+    uint64_t frag_offset = 0;
     uint64_t data_size = 0;
     double proc_time = 0;
-    ::omnetpp::opp_string src_addr;
-    ::omnetpp::opp_string des_addr;
-    ::omnetpp::opp_string master_id_addr;
-    ::omnetpp::opp_string next_hop_addr;
-    ::omnetpp::opp_string sendPath;
-    ::omnetpp::opp_string backPath;
+    uint32_t src_addr = UINT32_MAX;
+    uint32_t des_addr = UINT32_MAX;
+    uint32_t master_id_addr = UINT32_MAX;
+    uint32_t next_hop_addr = UINT32_MAX;
+    uint32_t send_route = UINT32_MAX;
+    uint32_t back_route = UINT32_MAX;
+    uint32_t load_route = UINT32_MAX;
+    uint16_t send_hop = 0;
+    uint16_t back_hop = 0;
     ::omnetpp::simtime_t generate_time = SIMTIME_ZERO;
     ::omnetpp::simtime_t arriveModule_time = SIMTIME_ZERO;
     ::omnetpp::simtime_t leaveModule_time = SIMTIME_ZERO;
@@ -125,29 +135,44 @@ class Request : public ::omnetpp::cPacket
     virtual uint32_t getFrag_size() const;
     virtual void setFrag_size(uint32_t frag_size);
 
+    virtual uint32_t getFrag_count() const;
+    virtual void setFrag_count(uint32_t frag_count);
+
+    virtual uint64_t getFrag_offset() const;
+    virtual void setFrag_offset(uint64_t frag_offset);
+
     virtual uint64_t getData_size() const;
     virtual void setData_size(uint64_t data_size);
 
     virtual double getProc_time() const;
     virtual void setProc_time(double proc_time);
 
-    virtual const char * getSrc_addr() const;
-    virtual void setSrc_addr(const char * src_addr);
+    virtual uint32_t getSrc_addr() const;
+    virtual void setSrc_addr(uint32_t src_addr);
+
+    virtual uint32_t getDes_addr() const;
+    virtual void setDes_addr(uint32_t des_addr);
+
+    virtual uint32_t getMaster_id_addr() const;
+    virtual void setMaster_id_addr(uint32_t master_id_addr);
+
+    virtual uint32_t getNext_hop_addr() const;
+    virtual void setNext_hop_addr(uint32_t next_hop_addr);
 
-    virtual const char * getDes_addr() const;
-    virtual void setDes_addr(const char * des_addr);
+    virtual uint32_t getSend_route() const;
+    virtual void setSend_route(uint32_t send_route);
 
-    virtual const char * getMaster_id_addr() const;
-    virtual void setMaster_id_addr(const char * master_id_addr);
+    virtual uint32_t getBack_route() const;
+    virtual void setBack_route(uint32_t back_route);
 
-    virtual const char * getNext_hop_addr() const;
-    virtual void setNext_hop_addr(const char * next_hop_addr);
+    virtual uint32_t getLoad_route() const;
+    virtual void setLoad_route(uint32_t load_route);
 
-    virtual const char * getSendPath() const;
-    virtual void setSendPath(const char * sendPath);
+    virtual uint16_t getSend_hop() const;
+    virtual void setSend_hop(uint16_t send_hop);
 
-    virtual const char * getBackPath() const;
-    virtual void setBackPath(const char * backPath);
+    virtual uint16_t getBack_hop() const;
+    virtual void setBack_hop(uint16_t back_hop);
 
     virtual ::omnetpp::simtime_t getGenerate_time() const;
     virtual void setGenerate_time(::omnetpp::simtime_t generate_time);